@@ -20,6 +20,7 @@
 #define DOSBOX_BIOS_DISK_H
 
 #include <stdio.h>
+#include <vector>
 #ifndef DOSBOX_MEM_H
 #include "mem.h"
 #endif
@@ -43,6 +44,44 @@ struct diskGeo {
 };
 extern diskGeo DiskGeometryList[];
 
+/* Copy-on-write overlay and compressed images, see bios_disk_overlay.cpp */
+class imageOverlay {
+public:
+	static imageOverlay * Open(FILE * imgFile, const char * imgName);
+	static Bit32u GetImageSize(FILE * imgFile);
+	static bool Create(const char * overlayName, const char * baseName);
+	static bool Compress(const char * imgName, const char * compressedName);
+	~imageOverlay();
+
+	Bit32u GetSize(void) { return image_size; }
+	void Read(Bit32u bytenum, Bit8u * data, Bit32u len);
+	bool Write(Bit32u bytenum, const Bit8u * data, Bit32u len);
+	void Flush(void);
+private:
+	imageOverlay();
+	bool OpenCompressed(FILE * file, const Bit8u * header);
+	bool LoadCompressed(Bit32u block);
+	void ReadBase(Bit32u bytenum, Bit8u * data, Bit32u len);
+
+	FILE * overlay;				/* NULL if a compressed image is used directly */
+	FILE * base;
+	bool own_base;
+	Bit32u image_size;
+	/* overlay: position of each modified block in the overlay file */
+	Bit32u block_size;
+	Bit32u index_offset;
+	Bit32u next_block;
+	std::vector<Bit32u> blocks;
+	/* compressed base: file offsets of the blocks, last decompressed block */
+	bool compressed;
+	Bit32u cimage_size;
+	Bit32u cblock_size;
+	std::vector<Bit32u> cindex;
+	std::vector<Bit8u> cbuffer;
+	std::vector<Bit8u> cdata;
+	Bit32u cached_block;
+};
+
 class imageDisk  {
 public:
 	Bit8u Read_Sector(Bit32u head,Bit32u cylinder,Bit32u sector,void * data);
@@ -55,7 +94,11 @@ public:
 	Bit8u GetBiosType(void);
 	Bit32u getSectSize(void);
 	imageDisk(FILE *imgFile, Bit8u *imgName, Bit32u imgSizeK, bool isHardDisk);
-	~imageDisk() { if(diskimg != NULL) { fclose(diskimg); }	};
+	~imageDisk();
+	void Flush(void);
+	void Tick(void);
+	void LogStats(void);
+	void Int13Written(Bit32u head,Bit32u cylinder,Bit32u sector);
 
 	bool hardDrive;
 	bool active;
@@ -65,9 +108,50 @@ public:
 
 	Bit32u sector_size;
 	Bit32u heads,cylinders,sectors;
+	imageDisk * next_disk;
+	/* Sectors a mounted drive keeps in memory (the FAT), writing them
+	   through INT 13 sets table_stale so the drive reloads them */
+	Bit32u table_start,table_end;
+	bool table_stale;
 private:
 	Bit32u current_fpos;
 	enum { NONE,READ,WRITE } last_action;
+	imageOverlay * layers;
+
+	/* Sector cache, blocks of consecutive sectors kept in LRU order */
+	struct cacheBlock {
+		Bit32u block;
+		Bit32u lru;
+		Bit32u valid;		/* bitmask of sectors holding data */
+		Bit32u dirty;		/* bitmask of sectors not yet written to the image */
+		bool used;
+	};
+	enum { CACHE_OFF,CACHE_ON,CACHE_MMAP } cache_mode;
+	cacheBlock * cache_blocks;
+	Bit8u * cache_data;
+	Bit32u cache_sector_size;
+	Bit32u cache_lru;
+	Bitu cache_last;
+	Bit32u last_read_sector;
+	Bit32u image_size;
+	Bit32u dirty_since;
+	bool cache_dirty;
+	bool write_checked,read_only;
+	Bit8u * mapped_image;
+	Bit32u mapped_size;
+	bool mapped_dirty;
+	struct {
+		Bit32u hits,misses,readahead,writes,flushed;
+	} cache_stats;
+
+	Bit8u * cacheSector(Bitu index,Bit32u sectnum);
+	Bitu cacheLookup(Bit32u block);
+	Bitu cacheAllocate(Bit32u block);
+	Bitu cacheLoad(Bit32u block,Bitu count);
+	void cacheWriteBack(Bitu index);
+	bool cacheReady(void);
+	void fileRead(Bit32u bytenum,void * data,Bit32u len);
+	bool fileWrite(Bit32u bytenum,void * data,Bit32u len);
 };
 
 void updateDPT(void);
@@ -82,6 +166,9 @@ extern Bit16u imgDTASeg; /* Real memory location of temporary DTA pointer for fa
 extern RealPt imgDTAPtr; /* Real memory location of temporary DTA pointer for fat image disk access */
 extern DOS_DTA *imgDTA;
 
+void BIOS_FlushDisks(void);
+void BIOS_ShutdownDisks(void);
+
 void swapInDisks(void);
 void swapInNextDisk(void);
 bool getSwapRequest(void);
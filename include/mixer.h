@@ -41,6 +41,8 @@ enum MixerModes {
 #define MIXER_BUFMASK (MIXER_BUFSIZE-1)
 extern Bit8u MixTemp[MIXER_BUFSIZE];
 
+#define MIXER_SINC_TAPS 16
+
 #define MAX_AUDIO ((1<<(16-1))-1)
 #define MIN_AUDIO -(1<<(16-1))
 
@@ -91,6 +93,11 @@ public:
 	//Previous and next samples
 	Bits prevSample[2];
 	Bits nextSample[2];
+	//Band-limited resampling, last input samples twice so a full window is always in one piece
+	Bit32s * sincTable;
+	double sincCutoff;
+	Bits history[MIXER_SINC_TAPS*2][2];
+	Bitu historyPos;
 	const char * name;
 	bool interpolate;
 	bool enabled;
@@ -85,6 +85,7 @@ typedef struct {
 	bool active;
 	bool aspect;
 	bool fullFrame;
+	bool nodisplay;
 } Render_t;
 
 extern Render_t render;
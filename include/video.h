@@ -25,7 +25,8 @@
 typedef enum {
 	GFX_CallBackReset,
 	GFX_CallBackStop,
-	GFX_CallBackRedraw
+	GFX_CallBackRedraw,
+	GFX_CallBackSync		//Finish all drawing into the output before it gets unlocked
 } GFX_CallBackFunctions_t;
 
 typedef void (*GFX_CallBack_t)( GFX_CallBackFunctions_t function );
@@ -53,6 +54,7 @@ struct GFX_PalEntry {
 #define GFX_HARDWARE	0x2000
 
 #define GFX_CAN_RANDOM	0x4000		//If the interface can also do random access surface
+#define GFX_NODISPLAY	0x8000		//Nothing gets displayed, the renderer can skip all scaling
 
 void GFX_Events(void);
 void GFX_SetPalette(Bitu start,Bitu count,GFX_PalEntry * entries);
@@ -161,6 +161,7 @@ static void IllegalOption(const char* msg) {
 	E_Exit("DynCore: illegal option in %s",msg);
 }
 
+#include "dyn_cache.h"
 #include "core_dyn_x86/cache.h" 
 
 static struct {
@@ -969,7 +969,7 @@ static void gen_fill_branch(Bit8u * data,Bit8u * from=cache.pos) {
 	if (len<0) len=-len;
 	if (len>126) LOG_MSG("Big jump %d",len);
 #endif
-	*data=(from-data-1);
+	*cache_rwptr(data)=(from-data-1);
 }
 
 static Bit8u * gen_create_branch_long(BranchTypes type) {
@@ -979,7 +979,7 @@ static Bit8u * gen_create_branch_long(BranchTypes type) {
 }
 
 static void gen_fill_branch_long(Bit8u * data,Bit8u * from=cache.pos) {
-	*(Bit32u*)data=(from-data-4);
+	*(Bit32u*)cache_rwptr(data)=(from-data-4);
 }
 
 static Bit8u * gen_create_jump(Bit8u * to=0) {
@@ -990,7 +990,7 @@ static Bit8u * gen_create_jump(Bit8u * to=0) {
 }
 
 static void gen_fill_jump(Bit8u * data,Bit8u * to=cache.pos) {
-	*(Bit32u*)data=(to-data-4);
+	*(Bit32u*)cache_rwptr(data)=(to-data-4);
 }
 
 
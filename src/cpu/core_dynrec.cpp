@@ -53,13 +53,17 @@
 #include "pic.h"
 
 #define CACHE_MAXSIZE	(4096*2)
-#define CACHE_TOTAL		(1024*1024*8)
+#define CACHE_TOTAL		(1024*1024*8)	// default size, see cache_init
 #define CACHE_PAGES		(512)
 #define CACHE_BLOCKS	(128*1024)
 #define CACHE_ALIGN		(16)
+#define CACHE_GENERATIONS	(3)		// unused passes a hot block survives
+#define CACHE_KEEPSCAN		(256)	// blocks the cache cursor skips before evicting anyway
 #define DYN_HASH_SHIFT	(4)
 #define DYN_PAGE_HASH	(4096>>DYN_HASH_SHIFT)
 #define DYN_LINKS		(16)
+#define DYN_TRACE_HOT	(256)	// taken branch count after which a block is translated again as a trace
+#define DYN_TRACE_JUMP	(128)	// maximum distance of a jump that is followed inside a trace
 
 
 //#define DYN_LOG 1 //Turn Logging on.
@@ -131,8 +135,6 @@ static struct {
 } core_dynrec;
 
 
-#include "core_dynrec/cache.h"
-
 #define X86			0x01
 #define X86_64		0x02
 #define MIPSEL		0x03
@@ -140,6 +142,15 @@ static struct {
 #define ARMV7LE		0x05
 #define ARMV8LE		0x07
 
+// the backend stores all generated code through cache_rwptr(), so the
+// code cache can be mapped twice on hosts that enforce W^X
+#if (C_TARGETCPU == X86_64) || (C_TARGETCPU == X86) || (C_TARGETCPU == ARMV8LE)
+#define DRC_USE_DUAL_MAPPING
+#endif
+
+#include "dyn_cache.h"
+#include "core_dynrec/cache.h"
+
 #if C_TARGETCPU == X86_64
 #include "core_dynrec/risc_x64.h"
 #elif C_TARGETCPU == X86
@@ -207,7 +218,7 @@ Bits CPU_Core_Dynrec_Run(void) {
 			// unless the instruction is known to be modified
 			if (!chandler->invalidation_map || (chandler->invalidation_map[ip_point&4095]<4)) {
 				// translate up to 32 instructions
-				block=CreateCacheBlock(chandler,ip_point,32);
+				block=CreateCacheBlock(chandler,ip_point,32,false);
 			} else {
 				// let the normal core handle this instruction to avoid zero-sized blocks
 				Bitu old_cycles=CPU_Cycles;
@@ -220,6 +231,13 @@ Bits CPU_Core_Dynrec_Run(void) {
 				CPU_CycleLeft+=old_cycles;
 				return nc_retcode;
 			}
+		} else if (GCC_UNLIKELY(block->cache.taken>=DYN_TRACE_HOT) &&
+				(!chandler->invalidation_map || (chandler->invalidation_map[ip_point&4095]<4))) {
+			// the conditional jump at the end of the block is taken a lot,
+			// translate it again as a trace that follows the jump
+			block->Clear();
+			block=CreateCacheBlock(chandler,ip_point,32,true);
+			cache.stats.traces++;
 		}
 
 run_block:
@@ -333,4 +351,41 @@ void CPU_Core_Dynrec_Cache_Close(void) {
 	cache_close();
 }
 
+void CPU_Core_Dynrec_Cache_Size(Bitu megabytes) {
+	// only has effect before the cache memory is allocated
+	if (!cache_code_start_ptr) cache_total=megabytes*1024*1024;
+}
+
+void CPU_Core_Dynrec_SetFlagsMode(bool optimize) {
+	// only affects blocks translated from now on
+	mf_enabled=optimize;
+}
+
+#if C_DEBUG
+void CPU_Core_Dynrec_ShowStats(void) {
+	DEBUG_ShowMsg("DYNREC: Cache %d KB, %d translations, %d evictions, %d retranslations, %d promotions, %d traces\n",
+		cache_total/1024,cache.stats.translations,cache.stats.evictions,cache.stats.retranslations,cache.stats.promotions,cache.stats.traces);
+	DEBUG_ShowMsg("DYNREC: Last second %d translations, %d evictions, %d retranslations\n",
+		cache.stats.rate_translations,cache.stats.rate_evictions,cache.stats.rate_retranslations);
+	if (!cache_blocks) return;
+	// memory accesses of the blocks in the cache and of the ones cleared before
+	Bit64u mem_fast=cache.stats.mem_fast,mem_slow=cache.stats.mem_slow;
+	CacheBlockDynRec * slowest=NULL;
+	Bitu cache_blocks_total=cache_total/(CACHE_TOTAL/CACHE_BLOCKS);
+	for (Bitu i=0;i<cache_blocks_total;i++) {
+		CacheBlockDynRec * block=&cache_blocks[i];
+		if (!block->page.handler) continue;
+		mem_fast+=block->mem.fast;
+		mem_slow+=block->mem.slow;
+		if (!slowest || (block->mem.slow>slowest->mem.slow)) slowest=block;
+	}
+	DEBUG_ShowMsg("DYNREC: Memory accesses %llu inline, %llu through handlers\n",
+		(unsigned long long)mem_fast,(unsigned long long)mem_slow);
+	if (slowest && slowest->mem.slow) {
+		DEBUG_ShowMsg("DYNREC: Most handler accesses: block at page %X offset %X, %d inline, %d through handlers\n",
+			slowest->page.handler->GetPhysPage(),slowest->page.start,slowest->mem.fast,slowest->mem.slow);
+	}
+}
+#endif
+
 #endif
@@ -44,6 +44,9 @@ public:
 		Bit8u * wmapmask;
 		Bit16u maskstart;
 		Bit16u masklen;
+		Bit8u used;				// block was run since the cache cursor passed it
+		Bit8u generation;		// passes without use this block survives
+		Bit32u taken;			// times the conditional jump at the end was taken, see DYN_TRACE_HOT
 	} cache;
 	struct {
 		Bitu index;
@@ -55,6 +58,11 @@ public:
 		CacheBlockDynRec * from;	// the from-block can transfer control to this block
 	} link[2];	// maximum two links (conditional jumps)
 	CacheBlockDynRec * crossblock;
+#if C_DEBUG
+	struct {
+		Bit32u fast,slow;		// memory accesses done inline or through the helper functions
+	} mem;
+#endif
 };
 
 static struct {
@@ -68,6 +76,15 @@ static struct {
 	CodePageHandlerDynRec * free_pages;		// pointer to the free list
 	CodePageHandlerDynRec * used_pages;		// pointer to the list of used pages
 	CodePageHandlerDynRec * last_page;		// the last used page
+	struct {
+		Bitu translations,evictions,retranslations,promotions,traces;
+		// counts of the last full second, for the logs and debugger
+		Bitu rate_translations,rate_evictions,rate_retranslations;
+		Bitu last_translations,last_evictions,last_retranslations;
+		Bitu last_tick;
+		Bit64u mem_fast,mem_slow;	// memory accesses of blocks that were cleared already
+	} stats;
+	Bit32u evicted[4096];	// recently evicted code addresses to spot retranslations
 } cache;
 
 
@@ -75,6 +92,7 @@ static struct {
 static Bit8u * cache_code_start_ptr=NULL;
 static Bit8u * cache_code=NULL;
 static Bit8u * cache_code_link_blocks=NULL;
+static Bitu cache_total=CACHE_TOTAL;		// size of the code cache, set from the config
 
 static CacheBlockDynRec * cache_blocks=NULL;
 static CacheBlockDynRec link_blocks[2];		// default linking (specially marked)
@@ -372,6 +390,10 @@ public:
 		return 0;	// none found
 	}
 
+	Bitu GetPhysPage(void) {
+		return phys_page;
+	}
+
 	HostPt GetHostReadPt(Bitu phys_page) { 
 		hostmem=old_pagehandler->GetHostReadPt(phys_page);
 		return hostmem;
@@ -451,6 +473,11 @@ void CacheBlockDynRec::Clear(void) {
 		// clear out the code page handler
 		page.handler->DelCacheBlock(this);
 		page.handler=0;
+#if C_DEBUG
+		::cache.stats.mem_fast+=mem.fast;
+		::cache.stats.mem_slow+=mem.slow;
+		mem.fast=mem.slow=0;
+#endif
 	}
 	if (cache.wmapmask){
 		free(cache.wmapmask);
@@ -459,30 +486,118 @@ void CacheBlockDynRec::Clear(void) {
 }
 
 
-static CacheBlockDynRec * cache_openblock(void) {
+// the block the cache cursor continues with after this one
+static INLINE CacheBlockDynRec * cache_nextblock(CacheBlockDynRec * block) {
+	if (!block->cache.next || (block->cache.next->cache.start>(cache_code_start_ptr + cache_total - CACHE_MAXSIZE)))
+		return cache.block.first;
+	return block->cache.next;
+}
+
+// decide if a block that is passed by the cache cursor stays in the cache
+static bool cache_keepblock(CacheBlockDynRec * block) {
+	if (block->cache.used) {
+		// was run since the last pass, move it up a generation
+		block->cache.used=0;
+		if (block->cache.generation<CACHE_GENERATIONS) {
+			block->cache.generation++;
+			cache.stats.promotions++;
+		}
+		return true;
+	}
+	if (block->cache.generation) {
+		// not used but was hot before, give it another pass
+		block->cache.generation--;
+		return true;
+	}
+	return false;
+}
+
+static INLINE Bitu cache_evictedindex(Bit32u addr) {
+	return (addr ^ (addr >> 12)) & 4095;
+}
+
+static void cache_evictblock(CacheBlockDynRec * block) {
+	Bit32u addr=(Bit32u)((block->page.handler->GetPhysPage()<<12)|block->page.start);
+	cache.evicted[cache_evictedindex(addr)]=addr;
+	cache.stats.evictions++;
+	block->Clear();
+}
+
+static void cache_updatestats(CodePageHandlerDynRec * codepage,Bitu start) {
+	Bit32u addr=(Bit32u)((codepage->GetPhysPage()<<12)|start);
+	Bitu index=cache_evictedindex(addr);
+	if (cache.evicted[index]==addr) {
+		cache.evicted[index]=0xffffffff;
+		cache.stats.retranslations++;
+	}
+	cache.stats.translations++;
+	if (PIC_Ticks-cache.stats.last_tick>=1000) {
+		cache.stats.last_tick=PIC_Ticks;
+		cache.stats.rate_translations=cache.stats.translations-cache.stats.last_translations;
+		cache.stats.rate_evictions=cache.stats.evictions-cache.stats.last_evictions;
+		cache.stats.rate_retranslations=cache.stats.retranslations-cache.stats.last_retranslations;
+		cache.stats.last_translations=cache.stats.translations;
+		cache.stats.last_evictions=cache.stats.evictions;
+		cache.stats.last_retranslations=cache.stats.retranslations;
+		if (cache.stats.rate_evictions) LOG(LOG_CPU,LOG_NORMAL)("Dynrec cache: %d translations, %d evictions, %d retranslations per second",
+			cache.stats.rate_translations,cache.stats.rate_evictions,cache.stats.rate_retranslations);
+	}
+}
+
+static CacheBlockDynRec * cache_openblock(CodePageHandlerDynRec * codepage,Bitu start) {
+	cache_updatestats(codepage,start);
 	CacheBlockDynRec * block=cache.block.active;
-	// check for enough space in this block
-	Bitu size=block->cache.size;
-	CacheBlockDynRec * nextblock=block->cache.next;
-	if (block->page.handler) 
-		block->Clear();
-	// block size must be at least CACHE_MAXSIZE
-	while (size<CACHE_MAXSIZE) {
-		if (!nextblock)
-			goto skipresize;
-		// merge blocks
-		size+=nextblock->cache.size;
-		CacheBlockDynRec * tempblock=nextblock->cache.next;
-		if (nextblock->page.handler) 
-			nextblock->Clear();
-		// block is free now
-		cache_addunusedblock(nextblock);
-		nextblock=tempblock;
+	Bitu size;
+	Bitu kept=0;
+	CacheBlockDynRec * nextblock;
+	for (;;) {
+		// skip the blocks that are still in use, but only up to a limit
+		// so a cache full of hot blocks doesn't get scanned over and over
+		if (block->page.handler && (kept<CACHE_KEEPSCAN) && cache_keepblock(block)) {
+			kept++;
+			block=cache_nextblock(block);
+			continue;
+		}
+		// check for enough space in this block
+		size=block->cache.size;
+		nextblock=block->cache.next;
+		if (block->page.handler) 
+			cache_evictblock(block);
+		// block size must be at least CACHE_MAXSIZE
+		while (size<CACHE_MAXSIZE) {
+			if (!nextblock)
+				goto skipresize;
+			// can't merge with a block that stays
+			if (nextblock->page.handler && (kept<CACHE_KEEPSCAN) && cache_keepblock(nextblock)) {
+				kept++;
+				break;
+			}
+			// merge blocks
+			size+=nextblock->cache.size;
+			CacheBlockDynRec * tempblock=nextblock->cache.next;
+			if (nextblock->page.handler) 
+				cache_evictblock(nextblock);
+			// block is free now
+			cache_addunusedblock(nextblock);
+			nextblock=tempblock;
+		}
+		if (size>=CACHE_MAXSIZE) break;
+		// too small, leave it as free space and continue behind the block that stays
+		block->cache.size=size;
+		block->cache.next=nextblock;
+		block=cache_nextblock(nextblock);
 	}
 skipresize:
 	// adjust parameters and open this block
+	cache.block.active=block;
 	block->cache.size=size;
 	block->cache.next=nextblock;
+	block->cache.used=0;
+	block->cache.generation=0;
+	block->cache.taken=0;
+#if C_DEBUG
+	block->mem.fast=block->mem.slow=0;
+#endif
 	cache.pos=block->cache.start;
 	return block;
 }
@@ -513,40 +628,38 @@ static void cache_closeblock(void) {
 			newblock->cache.start=block->cache.start+new_size;
 			newblock->cache.size=block->cache.size-new_size;
 			newblock->cache.next=block->cache.next;
+			newblock->cache.used=0;
+			newblock->cache.generation=0;
 			block->cache.next=newblock;
 			block->cache.size=new_size;
 		}
 	}
 	// advance the active block pointer
-	if (!block->cache.next || (block->cache.next->cache.start>(cache_code_start_ptr + CACHE_TOTAL - CACHE_MAXSIZE))) {
-//		LOG_MSG("Cache full restarting");
-		cache.block.active=cache.block.first;
-	} else {
-		cache.block.active=block->cache.next;
-	}
+	cache.block.active=cache_nextblock(block);
 }
 
 
 // place an 8bit value into the cache
 static INLINE void cache_addb(Bit8u val) {
-	*cache.pos++=val;
+	*cache_rwptr(cache.pos)=val;
+	cache.pos++;
 }
 
 // place a 16bit value into the cache
 static INLINE void cache_addw(Bit16u val) {
-	*(Bit16u*)cache.pos=val;
+	*(Bit16u*)cache_rwptr(cache.pos)=val;
 	cache.pos+=2;
 }
 
 // place a 32bit value into the cache
 static INLINE void cache_addd(Bit32u val) {
-	*(Bit32u*)cache.pos=val;
+	*(Bit32u*)cache_rwptr(cache.pos)=val;
 	cache.pos+=4;
 }
 
 // place a 64bit value into the cache
 static INLINE void cache_addq(Bit64u val) {
-	*(Bit64u*)cache.pos=val;
+	*(Bit64u*)cache_rwptr(cache.pos)=val;
 	cache.pos+=8;
 }
 
@@ -555,13 +668,6 @@ static void dyn_return(BlockReturn retcode,bool ret_exception);
 static void dyn_run_code(void);
 
 
-/* Define temporary pagesize so the MPROTECT case and the regular case share as much code as possible */
-#if (C_HAVE_MPROTECT)
-#define PAGESIZE_TEMP PAGESIZE
-#else 
-#define PAGESIZE_TEMP 4096
-#endif
-
 static bool cache_initialized = false;
 
 static void cache_init(bool enable) {
@@ -570,14 +676,18 @@ static void cache_init(bool enable) {
 		// see if cache is already initialized
 		if (cache_initialized) return;
 		cache_initialized = true;
+		// scale the number of blocks and pages with the configured cache size
+		if (cache_total<CACHE_TOTAL/8) cache_total=CACHE_TOTAL/8;
+		Bitu cache_blocks_total=cache_total/(CACHE_TOTAL/CACHE_BLOCKS);
+		Bitu cache_pages_total=cache_total/(CACHE_TOTAL/CACHE_PAGES);
 		if (cache_blocks == NULL) {
 			// allocate the cache blocks memory
-			cache_blocks=(CacheBlockDynRec*)malloc(CACHE_BLOCKS*sizeof(CacheBlockDynRec));
+			cache_blocks=(CacheBlockDynRec*)malloc(cache_blocks_total*sizeof(CacheBlockDynRec));
 			if(!cache_blocks) E_Exit("Allocating cache_blocks has failed");
-			memset(cache_blocks,0,sizeof(CacheBlockDynRec)*CACHE_BLOCKS);
+			memset(cache_blocks,0,sizeof(CacheBlockDynRec)*cache_blocks_total);
 			cache.block.free=&cache_blocks[0];
 			// initialize the cache blocks
-			for (i=0;i<CACHE_BLOCKS-1;i++) {
+			for (i=0;i<(Bits)cache_blocks_total-1;i++) {
 				cache_blocks[i].link[0].to=(CacheBlockDynRec *)1;
 				cache_blocks[i].link[1].to=(CacheBlockDynRec *)1;
 				cache_blocks[i].cache.next=&cache_blocks[i+1];
@@ -585,13 +695,10 @@ static void cache_init(bool enable) {
 		}
 		if (cache_code_start_ptr==NULL) {
 			// allocate the code cache memory
-#if defined (WIN32)
-			cache_code_start_ptr=(Bit8u*)VirtualAlloc(0,CACHE_TOTAL+CACHE_MAXSIZE+PAGESIZE_TEMP-1+PAGESIZE_TEMP,
-				MEM_COMMIT,PAGE_EXECUTE_READWRITE);
-			if (!cache_code_start_ptr)
-				cache_code_start_ptr=(Bit8u*)malloc(CACHE_TOTAL+CACHE_MAXSIZE+PAGESIZE_TEMP-1+PAGESIZE_TEMP);
+#if defined(DRC_USE_DUAL_MAPPING)
+			cache_code_start_ptr=cache_alloc_code(cache_total+CACHE_MAXSIZE+PAGESIZE_TEMP-1+PAGESIZE_TEMP,true);
 #else
-			cache_code_start_ptr=(Bit8u*)malloc(CACHE_TOTAL+CACHE_MAXSIZE+PAGESIZE_TEMP-1+PAGESIZE_TEMP);
+			cache_code_start_ptr=cache_alloc_code(cache_total+CACHE_MAXSIZE+PAGESIZE_TEMP-1+PAGESIZE_TEMP,false);
 #endif
 			if(!cache_code_start_ptr) E_Exit("Allocating dynamic cache failed");
 
@@ -601,15 +708,11 @@ static void cache_init(bool enable) {
 			cache_code_link_blocks=cache_code;
 			cache_code=cache_code+PAGESIZE_TEMP;
 
-#if (C_HAVE_MPROTECT)
-			if(mprotect(cache_code_link_blocks,CACHE_TOTAL+CACHE_MAXSIZE+PAGESIZE_TEMP,PROT_WRITE|PROT_READ|PROT_EXEC))
-				LOG_MSG("Setting execute permission on the code cache has failed");
-#endif
 			CacheBlockDynRec * block=cache_getblock();
 			cache.block.first=block;
 			cache.block.active=block;
 			block->cache.start=&cache_code[0];
-			block->cache.size=CACHE_TOTAL;
+			block->cache.size=cache_total;
 			block->cache.next=0;						// last block in the list
 		}
 		// setup the default blocks for block linkage returns
@@ -630,8 +733,10 @@ static void cache_init(bool enable) {
 		cache.free_pages=0;
 		cache.last_page=0;
 		cache.used_pages=0;
+		memset(&cache.stats,0,sizeof(cache.stats));
+		memset(cache.evicted,0xff,sizeof(cache.evicted));
 		// setup the code pages
-		for (i=0;i<CACHE_PAGES;i++) {
+		for (i=0;i<(Bits)cache_pages_total;i++) {
 			CodePageHandlerDynRec * newpage=new CodePageHandlerDynRec();
 			newpage->next=cache.free_pages;
 			cache.free_pages=newpage;
@@ -31,8 +31,13 @@
 	instruction is encountered.
 */
 
-static CacheBlockDynRec * CreateCacheBlock(CodePageHandlerDynRec * codepage,PhysPt start,Bitu max_opcodes) {
+static CacheBlockDynRec * CreateCacheBlock(CodePageHandlerDynRec * codepage,PhysPt start,Bitu max_opcodes,bool trace) {
 	// initialize a load of variables
+	decode.trace.active=trace;
+	decode.trace.side_exit=false;
+	decode.trace.unrolled=false;
+	decode.trace.start=start;
+	decode.trace.max_opcodes=max_opcodes;
 	decode.code_start=start;
 	decode.code=start;
 	decode.page.code=codepage;
@@ -40,15 +45,23 @@ static CacheBlockDynRec * CreateCacheBlock(CodePageHandlerDynRec * codepage,Phys
 	decode.page.wmap=codepage->write_map;
 	decode.page.invmap=codepage->invalidation_map;
 	decode.page.first=start >> 12;
-	decode.active_block=decode.block=cache_openblock();
+	decode.active_block=decode.block=cache_openblock(codepage,decode.page.index);
 	decode.block->page.start=(Bit16u)decode.page.index;
 	codepage->AddCacheBlock(decode.block);
 
 	InitFlagsOptimization();
+#if defined(DRC_USE_REGS_CACHE)
+	// blocks are entered without any guest registers in host registers
+	gen_regs_reset();
+#endif
 
 	// every codeblock that is run sets cache.block.running to itself
 	// so the block linking knows the last executed block
 	gen_mov_direct_ptr(&cache.block.running,(DRC_PTR_SIZE_IM)decode.block);
+	// mark the block as used on every entry, linked blocks don't pass the
+	// dispatcher so this can't be done there
+	gen_mov_byte_to_reg_low_imm(FC_TMP_BA1,1);
+	gen_mov_byte_from_reg_low(FC_TMP_BA1,&decode.block->cache.used);
 
 	// start with the cycles check
 	gen_mov_word_to_reg(FC_RETOP,&CPU_Cycles,true);
@@ -194,6 +207,21 @@ restart_prefix:
 				// short conditional jumps
 				case 0x80:case 0x81:case 0x82:case 0x83:case 0x84:case 0x85:case 0x86:case 0x87:	
 				case 0x88:case 0x89:case 0x8a:case 0x8b:case 0x8c:case 0x8d:case 0x8e:case 0x8f:	
+					if (decode.trace.active) {
+						if (decode.trace.side_exit) {
+							// only one side exit per trace, end it in front of the next one
+							if (!decode.trace.unrolled) goto trace_close_block;
+							// the second copy of the loop body ends with the back-edge
+							dyn_branched_loop_exit((BranchTypes)(dual_code&0xf),
+								decode.big_op ? (Bit32s)decode_fetchd() : (Bit16s)decode_fetchw());
+							goto finish_block;
+						}
+						if (max_opcodes) {
+							dyn_trace_branch((BranchTypes)(dual_code&0xf),
+								decode.big_op ? (Bit32s)decode_fetchd() : (Bit16s)decode_fetchw(),max_opcodes);
+							break;
+						}
+					}
 					dyn_branched_exit((BranchTypes)(dual_code&0xf),
 						decode.big_op ? (Bit32s)decode_fetchd() : (Bit16s)decode_fetchw());
 					goto finish_block;
@@ -297,6 +325,19 @@ restart_prefix:
 		// short conditional jumps
 		case 0x70:case 0x71:case 0x72:case 0x73:case 0x74:case 0x75:case 0x76:case 0x77:	
 		case 0x78:case 0x79:case 0x7a:case 0x7b:case 0x7c:case 0x7d:case 0x7e:case 0x7f:	
+			if (decode.trace.active) {
+				if (decode.trace.side_exit) {
+					// only one side exit per trace, end it in front of the next one
+					if (!decode.trace.unrolled) goto trace_close_block;
+					// the second copy of the loop body ends with the back-edge
+					dyn_branched_loop_exit((BranchTypes)(opcode&0xf),(Bit8s)decode_fetchb());
+					goto finish_block;
+				}
+				if (max_opcodes) {
+					dyn_trace_branch((BranchTypes)(opcode&0xf),(Bit8s)decode_fetchb(),max_opcodes);
+					break;
+				}
+			}
 			dyn_branched_exit((BranchTypes)(opcode&0xf),(Bit8s)decode_fetchb());	
 			goto finish_block;
 
@@ -487,11 +528,19 @@ restart_prefix:
 #endif
 
 
-		// loop instructions
-		case 0xe0:dyn_loop(LOOP_NE);goto finish_block;
-		case 0xe1:dyn_loop(LOOP_E);goto finish_block;
-		case 0xe2:dyn_loop(LOOP_NONE);goto finish_block;
-		case 0xe3:dyn_loop(LOOP_JCXZ);goto finish_block;
+		// loop instructions, these leave through link[1] as well
+		case 0xe0:
+			if (decode.trace.side_exit) goto trace_close_block;
+			dyn_loop(LOOP_NE);goto finish_block;
+		case 0xe1:
+			if (decode.trace.side_exit) goto trace_close_block;
+			dyn_loop(LOOP_E);goto finish_block;
+		case 0xe2:
+			if (decode.trace.side_exit) goto trace_close_block;
+			dyn_loop(LOOP_NONE);goto finish_block;
+		case 0xe3:
+			if (decode.trace.side_exit) goto trace_close_block;
+			dyn_loop(LOOP_JCXZ);goto finish_block;
 
 
 		// 'in al/ax/eax,port_imm'
@@ -514,17 +563,23 @@ restart_prefix:
 			dyn_call_near_imm();
 			goto finish_block;
 		// 'jmp near imm16/32'
-		case 0xe9:
-			dyn_exit_link(decode.big_op ? (Bit32s)decode_fetchd() : (Bit16s)decode_fetchw());
+		case 0xe9: {
+			Bits eip_change=decode.big_op ? (Bit32s)decode_fetchd() : (Bit16s)decode_fetchw();
+			if (dyn_trace_jump(eip_change)) break;
+			dyn_exit_link(eip_change);
 			goto finish_block;
+		}
 		// 'jmp far'
 		case 0xea:
 			dyn_jmp_far_imm();
 			goto finish_block;
 		// 'jmp short imm8'
-		case 0xeb:
-			dyn_exit_link((Bit8s)decode_fetchb());
+		case 0xeb: {
+			Bits eip_change=(Bit8s)decode_fetchb();
+			if (dyn_trace_jump(eip_change)) break;
+			dyn_exit_link(eip_change);
 			goto finish_block;
+		}
 
 
 		// repeat prefixes
@@ -599,6 +654,14 @@ core_close_block:
 	dyn_return(BR_Normal);
 	dyn_closeblock();
 	goto finish_block;
+trace_close_block:
+	// link to the next block that starts at the current instruction
+	decode.cycles--;
+	dyn_set_eip_last();
+	dyn_reduce_cycles();
+	gen_jmp_ptr(&decode.block->link[0].to,offsetof(CacheBlockDynRec,cache.start));
+	dyn_closeblock();
+	goto finish_block;
 illegalopcode:
 	// some unhandled opcode has been encountered
 	dyn_set_eip_last();
@@ -611,6 +674,17 @@ finish_block:
 	// setup the correct end-address
 	decode.page.index--;
 	decode.active_block->page.end=(Bit16u)decode.page.index;
+	if (decode.trace.unrolled) {
+		// the loop body was fetched twice, count it only once in the write map
+		Bit8u * mask=decode.block->cache.wmapmask;
+		Bitu maskstart=decode.block->cache.maskstart;
+		for (Bitu i=decode.block->page.start;i<decode.trace.loop_end;i++) {
+			// holes in the write map were not counted at all
+			if (mask && (i>=maskstart) && (i-maskstart<decode.block->cache.masklen) &&
+				mask[i-maskstart]) continue;
+			codepage->write_map[i]--;
+		}
+	}
 //	LOG_MSG("Created block size %d start %d end %d",decode.block->cache.size,decode.block->page.start,decode.block->page.end);
 
 	return decode.block;
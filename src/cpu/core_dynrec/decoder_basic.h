@@ -109,6 +109,16 @@ static struct DynDecode {
 	// block that contains the current byte of the instruction stream
 	CacheBlockDynRec * active_block;
 
+	// trace translation of a hot block, continues across jumps and conditional jumps
+	struct {
+		bool active;		// translating a trace
+		bool side_exit;		// a conditional jump already leaves through link[1]
+		bool unrolled;		// the loop body is translated a second time
+		PhysPt start;		// address of the first instruction
+		Bitu max_opcodes;	// instructions the trace may contain
+		Bitu loop_end;		// page index behind the back-edge of an unrolled loop
+	} trace;
+
 	// the active page (containing the current byte of the instruction stream)
 	struct {
 		CodePageHandlerDynRec * code;
@@ -762,47 +772,122 @@ bool DRC_CALL_CONV mem_writed_checked_drc(PhysPt address,Bit32u val) {
 
 // functions that enable access to the memory
 
+// the next function call leaves the guest registers alone, so
+// copies of them that the backend keeps in host registers stay valid
+static INLINE void dyn_pure_call(void) {
+#if defined(DRC_USE_REGS_CACHE)
+	regs_cache.pure_call=true;
+#endif
+}
+
+#if defined(DRC_USE_INLINE_TLB)
+// pages with a direct host pointer are accessed inline, the returned branch
+// has to be filled behind the helper call that handles all other accesses
+static DRC_PTR_SIZE_IM dyn_tlb_read(HostReg reg_addr,HostReg reg_dst,Bitu size) {
+	DRC_PTR_SIZE_IM slow=gen_tlb_lookup(reg_addr,false,size);
+	gen_tlb_read(reg_addr,reg_dst,size);
+#if C_DEBUG
+	gen_add_direct_word(&decode.block->mem.fast,1,true);
+#endif
+	DRC_PTR_SIZE_IM done=gen_create_jump_long();
+	gen_fill_tlb_branch(slow);
+#if C_DEBUG
+	gen_add_direct_word(&decode.block->mem.slow,1,true);
+#endif
+	return done;
+}
+
+static DRC_PTR_SIZE_IM dyn_tlb_write(HostReg reg_addr,HostReg reg_val,Bitu size) {
+	DRC_PTR_SIZE_IM slow=gen_tlb_lookup(reg_addr,true,size);
+	gen_tlb_write(reg_addr,reg_val,size);
+#if C_DEBUG
+	gen_add_direct_word(&decode.block->mem.fast,1,true);
+#endif
+	DRC_PTR_SIZE_IM done=gen_create_jump_long();
+	gen_fill_tlb_branch(slow);
+#if C_DEBUG
+	gen_add_direct_word(&decode.block->mem.slow,1,true);
+#endif
+	return done;
+}
+#endif
+
 // read a byte from a given address and store it in reg_dst
 static void dyn_read_byte(HostReg reg_addr,HostReg reg_dst) {
+#if defined(DRC_USE_INLINE_TLB)
+	DRC_PTR_SIZE_IM done=dyn_tlb_read(reg_addr,reg_dst,1);
+#endif
 	gen_mov_regs(FC_OP1,reg_addr);
+	dyn_pure_call();
 	gen_call_function_raw((void *)&mem_readb_checked_drc);
 	dyn_check_exception(FC_RETOP);
 	gen_mov_byte_to_reg_low(reg_dst,&core_dynrec.readdata);
+#if defined(DRC_USE_INLINE_TLB)
+	gen_fill_tlb_branch(done);
+#endif
 }
 static void dyn_read_byte_canuseword(HostReg reg_addr,HostReg reg_dst) {
+#if defined(DRC_USE_INLINE_TLB)
+	DRC_PTR_SIZE_IM done=dyn_tlb_read(reg_addr,reg_dst,1);
+#endif
 	gen_mov_regs(FC_OP1,reg_addr);
+	dyn_pure_call();
 	gen_call_function_raw((void *)&mem_readb_checked_drc);
 	dyn_check_exception(FC_RETOP);
 	gen_mov_byte_to_reg_low_canuseword(reg_dst,&core_dynrec.readdata);
+#if defined(DRC_USE_INLINE_TLB)
+	gen_fill_tlb_branch(done);
+#endif
 }
 
 // write a byte from reg_val into the memory given by the address
 static void dyn_write_byte(HostReg reg_addr,HostReg reg_val) {
+#if defined(DRC_USE_INLINE_TLB)
+	DRC_PTR_SIZE_IM done=dyn_tlb_write(reg_addr,reg_val,1);
+#endif
 	gen_mov_regs(FC_OP2,reg_val);
 	gen_mov_regs(FC_OP1,reg_addr);
+	dyn_pure_call();
 	gen_call_function_raw((void *)&mem_writeb_checked_drc);
 	dyn_check_exception(FC_RETOP);
+#if defined(DRC_USE_INLINE_TLB)
+	gen_fill_tlb_branch(done);
+#endif
 }
 
 // read a 32bit (dword=true) or 16bit (dword=false) value
 // from a given address and store it in reg_dst
 static void dyn_read_word(HostReg reg_addr,HostReg reg_dst,bool dword) {
+#if defined(DRC_USE_INLINE_TLB)
+	DRC_PTR_SIZE_IM done=dyn_tlb_read(reg_addr,reg_dst,dword?4:2);
+#endif
 	gen_mov_regs(FC_OP1,reg_addr);
+	dyn_pure_call();
 	if (dword) gen_call_function_raw((void *)&mem_readd_checked_drc);
 	else gen_call_function_raw((void *)&mem_readw_checked_drc);
 	dyn_check_exception(FC_RETOP);
 	gen_mov_word_to_reg(reg_dst,&core_dynrec.readdata,dword);
+#if defined(DRC_USE_INLINE_TLB)
+	gen_fill_tlb_branch(done);
+#endif
 }
 
 // write a 32bit (dword=true) or 16bit (dword=false) value
 // from reg_val into the memory given by the address
 static void dyn_write_word(HostReg reg_addr,HostReg reg_val,bool dword) {
+#if defined(DRC_USE_INLINE_TLB)
+	DRC_PTR_SIZE_IM done=dyn_tlb_write(reg_addr,reg_val,dword?4:2);
+#endif
 //	if (!dword) gen_extend_word(false,reg_val);
 	gen_mov_regs(FC_OP2,reg_val);
 	gen_mov_regs(FC_OP1,reg_addr);
+	dyn_pure_call();
 	if (dword) gen_call_function_raw((void *)&mem_writed_checked_drc);
 	else gen_call_function_raw((void *)&mem_writew_checked_drc);
 	dyn_check_exception(FC_RETOP);
+#if defined(DRC_USE_INLINE_TLB)
+	gen_fill_tlb_branch(done);
+#endif
 }
 
 
@@ -1206,26 +1291,66 @@ static void gen_restore_reg(HostReg reg,HostReg dest_reg) {
 // they try to find out if a function can be replaced by another
 // one that does not generate any flags at all
 
+// every queued function keeps the mask of condition flags it generates
+// that were not yet overwritten; once all of them are overwritten
+// without having been read the function is replaced by its simple variant
+
+static bool mf_enabled=true;
 static Bitu mf_functions_num=0;
 static struct {
 	Bit8u* pos;
 	void* fct_ptr;
 	Bitu ftype;
+	Bitu flags;
 } mf_functions[64];
 
 static void InitFlagsOptimization(void) {
 	mf_functions_num=0;
 }
 
+#ifdef DRC_FLAGS_INVALIDATION
+// the current instruction overwrites the condition flags in flags_mask,
+// replace the queued functions that have no live flags left
+static void KillFlags(Bitu flags_mask) {
+	Bitu num=0;
+	for (Bitu ct=0; ct<mf_functions_num; ct++) {
+		mf_functions[ct].flags&=~flags_mask;
+		if (mf_functions[ct].flags) mf_functions[num++]=mf_functions[ct];
+		else gen_fill_function_ptr(mf_functions[ct].pos,mf_functions[ct].fct_ptr,mf_functions[ct].ftype);
+	}
+	mf_functions_num=num;
+}
+
+static void QueueFunction(Bit8u* pos,void* simple_function,Bitu flags_type,Bitu flags_mask) {
+	if (!mf_enabled || (mf_functions_num>=64)) return;
+	mf_functions[mf_functions_num].pos=pos;
+	mf_functions[mf_functions_num].fct_ptr=simple_function;
+	mf_functions[mf_functions_num].ftype=flags_type;
+	mf_functions[mf_functions_num].flags=flags_mask;
+	mf_functions_num++;
+}
+
+// condition flags a partially flag-generating function always overwrites
+static Bitu WrittenFlags(Bitu flags_type) {
+	switch (flags_type) {
+		case t_INCb:case t_INCw:case t_INCd:
+		case t_DECb:case t_DECw:case t_DECd:
+			return FMASK_TEST & ~FLAG_CF;
+		case t_ADCb:case t_ADCw:case t_ADCd:
+		case t_SBBb:case t_SBBw:case t_SBBd:
+			return FMASK_TEST;	// carry flag was acquired before
+		default:
+			return 0;			// shifts leave the flags alone for count zero
+	}
+}
+#endif
+
 // replace all queued functions with their simpler variants
 // because the current instruction destroys all condition flags and
 // the flags are not required before
 static void InvalidateFlags(void) {
 #ifdef DRC_FLAGS_INVALIDATION
-	for (Bitu ct=0; ct<mf_functions_num; ct++) {
-		gen_fill_function_ptr(mf_functions[ct].pos,mf_functions[ct].fct_ptr,mf_functions[ct].ftype);
-	}
-	mf_functions_num=0;
+	KillFlags(FMASK_TEST);
 #endif
 }
 
@@ -1234,43 +1359,41 @@ static void InvalidateFlags(void) {
 // the flags are not required before
 static void InvalidateFlags(void* current_simple_function,Bitu flags_type) {
 #ifdef DRC_FLAGS_INVALIDATION
-	for (Bitu ct=0; ct<mf_functions_num; ct++) {
-		gen_fill_function_ptr(mf_functions[ct].pos,mf_functions[ct].fct_ptr,mf_functions[ct].ftype);
-	}
-	mf_functions_num=1;
-	mf_functions[0].pos=cache.pos;
-	mf_functions[0].fct_ptr=current_simple_function;
-	mf_functions[0].ftype=flags_type;
+	KillFlags(FMASK_TEST);
+	QueueFunction(cache.pos,current_simple_function,flags_type,FMASK_TEST);
 #endif
 }
 
-// enqueue this instruction, if later an instruction is encountered that
-// destroys all condition flags and the flags weren't needed in-between
-// this function can be replaced by a simpler one as well
+// enqueue this instruction, if later instructions overwrite the flags it
+// generates and the flags weren't needed in-between this function can be
+// replaced by a simpler one as well; inc/dec overwrite all flags but carry
 static void InvalidateFlagsPartially(void* current_simple_function,Bitu flags_type) {
 #ifdef DRC_FLAGS_INVALIDATION
-	mf_functions[mf_functions_num].pos=cache.pos;
-	mf_functions[mf_functions_num].fct_ptr=current_simple_function;
-	mf_functions[mf_functions_num].ftype=flags_type;
-	mf_functions_num++;
+	Bitu written=WrittenFlags(flags_type);
+	KillFlags(written);
+	QueueFunction(cache.pos,current_simple_function,flags_type,written ? written : FMASK_TEST);
 #endif
 }
 
-// enqueue this instruction, if later an instruction is encountered that
-// destroys all condition flags and the flags weren't needed in-between
-// this function can be replaced by a simpler one as well
+// enqueue this instruction, if later instructions overwrite the flags it
+// generates and the flags weren't needed in-between this function can be
+// replaced by a simpler one as well
 static void InvalidateFlagsPartially(void* current_simple_function,DRC_PTR_SIZE_IM cpos,Bitu flags_type) {
 #ifdef DRC_FLAGS_INVALIDATION
-	mf_functions[mf_functions_num].pos=(Bit8u*)cpos;
-	mf_functions[mf_functions_num].fct_ptr=current_simple_function;
-	mf_functions[mf_functions_num].ftype=flags_type;
-	mf_functions_num++;
+	Bitu written=WrittenFlags(flags_type);
+	KillFlags(written);
+	QueueFunction((Bit8u*)cpos,current_simple_function,flags_type,written ? written : FMASK_TEST);
 #endif
 }
 
-// the current function needs the condition flags thus reset the queue
+// the current function needs the condition flags in flags_mask thus
+// remove the queued functions that generate any of them
 static void AcquireFlags(Bitu flags_mask) {
 #ifdef DRC_FLAGS_INVALIDATION
-	mf_functions_num=0;
+	Bitu num=0;
+	for (Bitu ct=0; ct<mf_functions_num; ct++) {
+		if (!(mf_functions[ct].flags & flags_mask)) mf_functions[num++]=mf_functions[ct];
+	}
+	mf_functions_num=num;
 #endif
 }
@@ -1090,6 +1090,7 @@ static void dyn_cwd(void) {
 static void dyn_sahf(void) {
 	MOV_REG_WORD16_TO_HOST_REG(FC_OP1,DRC_REG_EAX);
 	gen_call_function_raw((void *)&dynrec_sahf);
+	AcquireFlags(FLAG_OF);	// overflow flag is carried over
 	InvalidateFlags();
 }
 
@@ -1114,12 +1115,113 @@ static void dyn_branched_exit(BranchTypes btype,Bit32s eip_add) {
  	gen_jmp_ptr(&decode.block->link[0].to,offsetof(CacheBlockDynRec,cache.start));
  	gen_fill_branch(data);
 
- 	// Branch taken
+ 	// Branch taken, count it so the core can translate the block
+	// again as a trace that follows the jump (see DYN_TRACE_HOT)
+	if (!decode.trace.active) gen_add_direct_word(&decode.block->cache.taken,1,true);
 	gen_add_direct_word(&reg_eip,eip_base+eip_add,decode.big_op);
  	gen_jmp_ptr(&decode.block->link[1].to,offsetof(CacheBlockDynRec,cache.start));
  	dyn_closeblock();
 }
 
+// a jump inside a trace that can be followed by skipping the bytes
+// up to its target, short forward jumps in the same page only
+static bool dyn_trace_can_skip(Bits eip_change) {
+	if (!decode.big_op || !cpu.code.big) return false;
+	if (eip_change<=0 || eip_change>DYN_TRACE_JUMP) return false;
+	return (decode.page.index+eip_change<4096);
+}
+
+// continue the translation at the target of a forward jump
+static void dyn_trace_skip(Bits eip_change) {
+	gen_add_direct_word(&reg_eip,(decode.code-decode.code_start)+eip_change,true);
+	// the skipped bytes are not part of this block, keep them out of the write map
+	for (Bits i=0;i<eip_change;i++) {
+		decode_increase_wmapmask(1);
+		decode.page.index++;
+	}
+	decode.code+=eip_change;
+	decode.code_start=decode.code;
+}
+
+static bool dyn_trace_jump(Bits eip_change) {
+	if (!decode.trace.active || !dyn_trace_can_skip(eip_change)) return false;
+	dyn_trace_skip(eip_change);
+	return true;
+}
+
+// conditional jump inside a trace, the taken path leaves the block
+// and translation continues with the next instruction
+static void dyn_branched_side_exit(BranchTypes btype,Bit32s eip_add) {
+	Bitu eip_base=decode.code-decode.code_start;
+	dyn_branchflag_to_reg(btype);
+	DRC_PTR_SIZE_IM data=gen_create_branch_on_zero(FC_RETOP,true);
+
+	// Branch taken
+	dyn_reduce_cycles();
+	gen_add_direct_word(&reg_eip,eip_base+eip_add,decode.big_op);
+	gen_jmp_ptr(&decode.block->link[1].to,offsetof(CacheBlockDynRec,cache.start));
+	gen_fill_branch(data);
+
+	// the taken path can still need the flags of the code before
+	AcquireFlags(FMASK_TEST);
+	decode.trace.side_exit=true;
+}
+
+// first conditional jump of a trace, the one that was taken often enough
+// to make the block hot; the trace follows it and the fall-through leaves
+static void dyn_trace_branch(BranchTypes btype,Bit32s eip_add,Bitu max_opcodes) {
+	Bitu eip_base=decode.code-decode.code_start;
+	// instructions of the trace up to and including this one
+	Bitu length=decode.trace.max_opcodes-max_opcodes;
+	bool loop=(decode.code+eip_add==decode.trace.start) &&
+		(max_opcodes>=length) && (decode.active_block==decode.block);
+	if (!loop && !dyn_trace_can_skip(eip_add)) {
+		dyn_branched_side_exit(btype,eip_add);
+		return;
+	}
+	dyn_branchflag_to_reg(btype);
+	DRC_PTR_SIZE_IM data=gen_create_branch_on_nonzero(FC_RETOP,true);
+
+	// Branch not taken
+	dyn_reduce_cycles();
+	gen_add_direct_word(&reg_eip,eip_base,decode.big_op);
+	gen_jmp_ptr(&decode.block->link[1].to,offsetof(CacheBlockDynRec,cache.start));
+	gen_fill_branch(data);
+
+	if (loop) {
+		// back-edge to the start of the trace, translate the loop body
+		// once more so only every second iteration leaves the block
+		gen_add_direct_word(&reg_eip,eip_base+eip_add,decode.big_op);
+		decode.trace.loop_end=decode.page.index;
+		decode.trace.unrolled=true;
+		decode.page.index=decode.block->page.start;
+		decode.code=decode.code_start=decode.trace.start;
+	} else dyn_trace_skip(eip_add);
+
+	AcquireFlags(FMASK_TEST);
+	decode.trace.side_exit=true;
+}
+
+// back-edge at the end of an unrolled loop, the fall-through goes to
+// the same place as the exit of the first copy of the loop body
+static void dyn_branched_loop_exit(BranchTypes btype,Bit32s eip_add) {
+	Bitu eip_base=decode.code-decode.code_start;
+	dyn_reduce_cycles();
+
+	dyn_branchflag_to_reg(btype);
+	DRC_PTR_SIZE_IM data=gen_create_branch_on_nonzero(FC_RETOP,true);
+
+	// Branch not taken
+	gen_add_direct_word(&reg_eip,eip_base,decode.big_op);
+	gen_jmp_ptr(&decode.block->link[1].to,offsetof(CacheBlockDynRec,cache.start));
+	gen_fill_branch(data);
+
+	// Branch taken, links back to the trace itself
+	gen_add_direct_word(&reg_eip,eip_base+eip_add,decode.big_op);
+	gen_jmp_ptr(&decode.block->link[0].to,offsetof(CacheBlockDynRec,cache.start));
+	dyn_closeblock();
+}
+
 /*
 static void dyn_set_byte_on_condition(BranchTypes btype) {
 	dyn_get_modrm();
@@ -392,6 +392,7 @@ static void DRC_CALL_CONV dynrec_test_dword_simple(Bit32u op1,Bit32u op2) {
 
 
 static void dyn_dop_byte_gencall(DualOps op) {
+	dyn_pure_call();
 	switch (op) {
 		case DOP_ADD:
 			InvalidateFlags((void*)&dynrec_add_byte_simple,t_ADDb);
@@ -436,6 +437,7 @@ static void dyn_dop_byte_gencall(DualOps op) {
 }
 
 static void dyn_dop_word_gencall(DualOps op,bool dword) {
+	dyn_pure_call();
 	if (dword) {
 		switch (op) {
 			case DOP_ADD:
@@ -664,6 +666,7 @@ static Bit32u DRC_CALL_CONV dynrec_neg_dword_simple(Bit32u op) {
 
 
 static void dyn_sop_byte_gencall(SingleOps op) {
+	dyn_pure_call();
 	switch (op) {
 		case SOP_INC:
 			InvalidateFlagsPartially((void*)&dynrec_inc_byte_simple,t_INCb);
@@ -685,6 +688,7 @@ static void dyn_sop_byte_gencall(SingleOps op) {
 }
 
 static void dyn_sop_word_gencall(SingleOps op,bool dword) {
+	dyn_pure_call();
 	if (dword) {
 		switch (op) {
 			case SOP_INC:
@@ -1112,6 +1116,7 @@ static Bit32u DRC_CALL_CONV dynrec_sar_dword_simple(Bit32u op1,Bit8u op2) {
 }
 
 static void dyn_shift_byte_gencall(ShiftOps op) {
+	dyn_pure_call();
 	switch (op) {
 		case SHIFT_ROL:
 			InvalidateFlagsPartially((void*)&dynrec_rol_byte_simple,t_ROLb);
@@ -1147,6 +1152,7 @@ static void dyn_shift_byte_gencall(ShiftOps op) {
 }
 
 static void dyn_shift_word_gencall(ShiftOps op,bool dword) {
+	dyn_pure_call();
 	if (dword) {
 		switch (op) {
 			case SHIFT_ROL:
@@ -1297,6 +1303,7 @@ static Bit32u DRC_CALL_CONV dynrec_dshr_dword_simple(Bit32u op1,Bit32u op2,Bit8u
 }
 
 static void dyn_dpshift_word_gencall(bool left) {
+	dyn_pure_call();
 	if (left) {
 		DRC_PTR_SIZE_IM proc_addr=gen_call_function_R3((void*)&dynrec_dshl_word,FC_OP3);
 		InvalidateFlagsPartially((void*)&dynrec_dshl_word_simple,proc_addr,t_DSHLw);
@@ -1307,6 +1314,7 @@ static void dyn_dpshift_word_gencall(bool left) {
 }
 
 static void dyn_dpshift_dword_gencall(bool left) {
+	dyn_pure_call();
 	if (left) {
 		DRC_PTR_SIZE_IM proc_addr=gen_call_function_R3((void*)&dynrec_dshl_dword,FC_OP3);
 		InvalidateFlagsPartially((void*)&dynrec_dshl_dword_simple,proc_addr,t_DSHLd);
@@ -1354,6 +1362,7 @@ static Bit32u DRC_CALL_CONV dynrec_get_nzf_and_sf_eq_of(void)	{ return TFLG_NLE;
 
 
 static void dyn_branchflag_to_reg(BranchTypes btype) {
+	dyn_pure_call();
 	switch (btype) {
 		case BR_O:gen_call_function_raw((void*)&dynrec_get_of);break;
 		case BR_NO:gen_call_function_raw((void*)&dynrec_get_nof);break;
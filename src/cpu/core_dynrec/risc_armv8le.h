@@ -195,6 +195,13 @@ typedef Bit8u HostReg;
 // used to hold the address of "core_dynrec.readdata" - filled in function gen_run_code
 #define readdata_addr HOST_r22
 
+// keep 32bit guest registers in x23-x26 that are preserved across function
+// calls; stores go to cpu_regs as well so that helper functions and block
+// exits always see the current values and nothing needs to be spilled
+#define DRC_USE_REGS_CACHE
+#define REGS_CACHE_SIZE 4
+#define REGS_CACHE_FIRST HOST_r23
+
 
 // instruction encodings
 
@@ -407,8 +414,78 @@ static bool gen_mov_memval_to_reg_helper(HostReg dest_reg, Bit64u data, Bitu siz
 	return false;
 }
 
+static struct {
+	Bits guest[REGS_CACHE_SIZE];	// guest register held by x23+i, -1 if none
+	Bitu used[REGS_CACHE_SIZE];		// when the host register was last used
+	Bitu clock;
+	bool pure_call;			// the next called function leaves the guest registers alone
+} regs_cache;
+
+// forget all cached guest registers
+static void gen_regs_reset(void) {
+	for (Bitu i=0;i<REGS_CACHE_SIZE;i++) regs_cache.guest[i]=-1;
+	regs_cache.pure_call=false;
+}
+
+// guest register that data points into, -1 for other memory
+static Bits gen_regs_guest(void* data) {
+	Bit8u* base=(Bit8u*)&cpu_regs.regs[0];
+	if (((Bit8u*)data<base) || ((Bit8u*)data>=(Bit8u*)&cpu_regs.regs[8])) return -1;
+	return (Bits)(((Bit8u*)data-base)/sizeof(cpu_regs.regs[0]));
+}
+
+// host register that holds the guest register, -1 if it is not cached
+static Bits gen_regs_find(Bits guest) {
+	for (Bitu i=0;i<REGS_CACHE_SIZE;i++) {
+		if (regs_cache.guest[i]==guest) {
+			regs_cache.used[i]=++regs_cache.clock;
+			return (Bits)i;
+		}
+	}
+	return -1;
+}
+
+// host register to hold the guest register from now on, the least
+// recently used one is taken if all of them are in use
+static Bitu gen_regs_alloc(Bits guest) {
+	Bits slot=gen_regs_find(guest);
+	if (slot>=0) return (Bitu)slot;
+	Bitu pick=0;
+	for (Bitu i=0;i<REGS_CACHE_SIZE;i++) {
+		if (regs_cache.guest[i]<0) {
+			pick=i;
+			break;
+		}
+		if (regs_cache.used[i]<regs_cache.used[pick]) pick=i;
+	}
+	regs_cache.guest[pick]=guest;
+	regs_cache.used[pick]=++regs_cache.clock;
+	return pick;
+}
+
+// the guest register in memory is changed, drop the cached copy
+static void gen_regs_drop(Bits guest) {
+	for (Bitu i=0;i<REGS_CACHE_SIZE;i++) {
+		if (regs_cache.guest[i]==guest) regs_cache.guest[i]=-1;
+	}
+}
+
 // helper function
 static bool gen_mov_memval_to_reg(HostReg dest_reg, void *data, Bitu size) {
+	Bits guest=gen_regs_guest(data);
+	bool whole=(guest>=0) && (data==(void*)&cpu_regs.regs[guest]);
+	if (whole && ((size==4) || (size==2))) {
+		Bits slot=gen_regs_find(guest);
+		if (slot>=0) {
+			if (size==4) cache_addd( MOV_REG_LSL_IMM(dest_reg, REGS_CACHE_FIRST+slot, 0) );      // mov dest_reg, x23..x26
+			else cache_addd( UXTH(dest_reg, REGS_CACHE_FIRST+slot) );                          // uxth dest_reg, x23..x26
+			return true;
+		}
+		if ((size==4) && gen_mov_memval_to_reg_helper(dest_reg, (Bit64u)data, size, FC_REGS_ADDR, (Bit64u)&cpu_regs)) {
+			cache_addd( MOV_REG_LSL_IMM(REGS_CACHE_FIRST+gen_regs_alloc(guest), dest_reg, 0) );  // mov x23..x26, dest_reg
+			return true;
+		}
+	}
 	if (gen_mov_memval_to_reg_helper(dest_reg, (Bit64u)data, size, FC_REGS_ADDR, (Bit64u)&cpu_regs)) return true;
 	if (gen_mov_memval_to_reg_helper(dest_reg, (Bit64u)data, size, readdata_addr, (Bit64u)&core_dynrec.readdata)) return true;
 	if (gen_mov_memval_to_reg_helper(dest_reg, (Bit64u)data, size, FC_SEGS_ADDR, (Bit64u)&Segs)) return true;
@@ -522,6 +599,16 @@ static bool gen_mov_memval_from_reg_helper(HostReg src_reg, Bit64u data, Bitu si
 
 // helper function
 static bool gen_mov_memval_from_reg(HostReg src_reg, void *dest, Bitu size) {
+	Bits guest=gen_regs_guest(dest);
+	if (guest>=0) {
+		if ((size==4) && (dest==(void*)&cpu_regs.regs[guest])) {
+			if (!gen_mov_memval_from_reg_helper(src_reg, (Bit64u)dest, size, FC_REGS_ADDR, (Bit64u)&cpu_regs)) return false;
+			cache_addd( MOV_REG_LSL_IMM(REGS_CACHE_FIRST+gen_regs_alloc(guest), src_reg, 0) );   // mov x23..x26, src_reg
+			return true;
+		}
+		gen_regs_drop(guest);
+		if (size==8) gen_regs_drop(guest+1);
+	}
 	if (gen_mov_memval_from_reg_helper(src_reg, (Bit64u)dest, size, FC_REGS_ADDR, (Bit64u)&cpu_regs)) return true;
 	if (gen_mov_memval_from_reg_helper(src_reg, (Bit64u)dest, size, readdata_addr, (Bit64u)&core_dynrec.readdata)) return true;
 	if (gen_mov_memval_from_reg_helper(src_reg, (Bit64u)dest, size, FC_SEGS_ADDR, (Bit64u)&Segs)) return true;
@@ -763,6 +850,10 @@ static void INLINE gen_call_function_raw(void * func) {
 	cache_addd( MOVK64(temp1, (((Bit64u)func) >> 32) & 0xffff, 32) );   // movk dest_reg, #((func >> 32) & 0xffff), lsl #32
 	cache_addd( MOVK64(temp1, (((Bit64u)func) >> 48) & 0xffff, 48) );   // movk dest_reg, #((func >> 48) & 0xffff), lsl #48
 	cache_addd( BLR_REG(temp1) );      // blr temp1
+
+	// the called function may have changed the guest registers in memory
+	if (!regs_cache.pure_call) gen_regs_reset();
+	regs_cache.pure_call=false;
 }
 
 // generate a call to a function with paramcount parameters
@@ -844,7 +935,9 @@ static void INLINE gen_fill_branch(DRC_PTR_SIZE_IM data) {
 	if (len<0) len=-len;
 	if (len>=0x00100000) LOG_MSG("Big jump %d",len);
 #endif
-	*(Bit32u*)data=( (*(Bit32u*)data) & 0xff00001f ) | ( ( ((Bit64u)cache.pos - data) << 3 ) & 0x00ffffe0 );
+	*(Bit32u*)cache_rwptr((Bit8u*)data)=( (*(Bit32u*)data) & 0xff00001f ) | ( ( ((Bit64u)cache.pos - data) << 3 ) & 0x00ffffe0 );
+	// code paths join here, the cached guest registers may differ
+	gen_regs_reset();
 }
 
 // conditional jump if register is nonzero
@@ -872,16 +965,19 @@ static DRC_PTR_SIZE_IM gen_create_branch_long_leqzero(HostReg reg) {
 // calculate long relative offset and fill it into the location pointed to by data
 static void INLINE gen_fill_branch_long(DRC_PTR_SIZE_IM data) {
 	// optimize for shorter branches ?
-	*(Bit32u*)data=( (*(Bit32u*)data) & 0xfc000000 ) | ( ( ((Bit64u)cache.pos - data) >> 2 ) & 0x03ffffff );
+	*(Bit32u*)cache_rwptr((Bit8u*)data)=( (*(Bit32u*)data) & 0xfc000000 ) | ( ( ((Bit64u)cache.pos - data) >> 2 ) & 0x03ffffff );
+	gen_regs_reset();
 }
 
 static void gen_run_code(void) {
 	Bit8u *pos1, *pos2, *pos3;
 
-	cache_addd( 0xa9bd7bfd );                                           // stp fp, lr, [sp, #-48]!
+	cache_addd( 0xa9bb7bfd );                                           // stp fp, lr, [sp, #-80]!
 	cache_addd( 0x910003fd );                                           // mov fp, sp
 	cache_addd( STP64_IMM(FC_ADDR, FC_REGS_ADDR, HOST_sp, 16) );        // stp FC_ADDR, FC_REGS_ADDR, [sp, #16]
 	cache_addd( STP64_IMM(FC_SEGS_ADDR, readdata_addr, HOST_sp, 32) );  // stp FC_SEGS_ADDR, readdata_addr, [sp, #32]
+	cache_addd( STP64_IMM(HOST_x23, HOST_x24, HOST_sp, 48) );           // stp x23, x24, [sp, #48]
+	cache_addd( STP64_IMM(HOST_x25, HOST_x26, HOST_sp, 64) );           // stp x25, x26, [sp, #64]
 
 	pos1 = cache.pos;
 	cache_addd( 0 );
@@ -897,13 +993,13 @@ static void gen_run_code(void) {
 		cache.pos = cache.pos + (32 - (((Bitu)cache.pos) & 0x1f));
 	}
 
-	*(Bit32u *)pos1 = LDR64_PC(FC_SEGS_ADDR, cache.pos - pos1);   // ldr FC_SEGS_ADDR, [pc, #(&Segs)]
+	*(Bit32u *)cache_rwptr(pos1) = LDR64_PC(FC_SEGS_ADDR, cache.pos - pos1);   // ldr FC_SEGS_ADDR, [pc, #(&Segs)]
 	cache_addq((Bit64u)&Segs);                      // address of "Segs"
 
-	*(Bit32u *)pos2 = LDR64_PC(FC_REGS_ADDR, cache.pos - pos2);   // ldr FC_REGS_ADDR, [pc, #(&cpu_regs)]
+	*(Bit32u *)cache_rwptr(pos2) = LDR64_PC(FC_REGS_ADDR, cache.pos - pos2);   // ldr FC_REGS_ADDR, [pc, #(&cpu_regs)]
 	cache_addq((Bit64u)&cpu_regs);                  // address of "cpu_regs"
 
-	*(Bit32u *)pos3 = LDR64_PC(readdata_addr, cache.pos - pos3);  // ldr readdata_addr, [pc, #(&core_dynrec.readdata)]
+	*(Bit32u *)cache_rwptr(pos3) = LDR64_PC(readdata_addr, cache.pos - pos3);  // ldr readdata_addr, [pc, #(&core_dynrec.readdata)]
 	cache_addq((Bit64u)&core_dynrec.readdata);      // address of "core_dynrec.readdata"
 
 	// align cache.pos to 32 bytes
@@ -916,7 +1012,9 @@ static void gen_run_code(void) {
 static void gen_return_function(void) {
 	cache_addd( LDP64_IMM(FC_ADDR, FC_REGS_ADDR, HOST_sp, 16) );        // ldp FC_ADDR, FC_REGS_ADDR, [sp, #16]
 	cache_addd( LDP64_IMM(FC_SEGS_ADDR, readdata_addr, HOST_sp, 32) );  // ldp FC_SEGS_ADDR, readdata_addr, [sp, #32]
-	cache_addd( 0xa8c37bfd );                                           // ldp fp, lr, [sp], #48
+	cache_addd( LDP64_IMM(HOST_x23, HOST_x24, HOST_sp, 48) );           // ldp x23, x24, [sp, #48]
+	cache_addd( LDP64_IMM(HOST_x25, HOST_x26, HOST_sp, 64) );           // ldp x25, x26, [sp, #64]
+	cache_addd( 0xa8c57bfd );                                           // ldp fp, lr, [sp], #80
 	cache_addd( RET );                                                  // ret
 }
 
@@ -925,6 +1023,7 @@ static void gen_return_function(void) {
 // called when a call to a function can be replaced by a
 // call to a simpler function
 static void gen_fill_function_ptr(Bit8u * pos,void* fct_ptr,Bitu flags_type) {
+	pos=cache_rwptr(pos);
 #ifdef DRC_FLAGS_INVALIDATION_DCODE
 	// try to avoid function calls but rather directly fill in code
 	switch (flags_type) {
@@ -1166,25 +1265,47 @@ static void gen_add_seg32_to_reg(HostReg reg,Bitu index) {
 
 #ifdef DRC_USE_REGS_ADDR
 
+// guest register that starts at cpu_regs[index], -1 for anything else
+static Bits gen_regs_index(Bitu index) {
+	void* data=(Bit8u*)&cpu_regs+index;
+	Bits guest=gen_regs_guest(data);
+	if ((guest<0) || (data!=(void*)&cpu_regs.regs[guest])) return -1;
+	return guest;
+}
+
 // mov 16bit value from cpu_regs[index] into dest_reg using FC_REGS_ADDR (index modulo 2 must be zero)
 // 16bit moves may destroy the upper 16bit of the destination register
 static void gen_mov_regval16_to_reg(HostReg dest_reg,Bitu index) {
+	Bits guest=gen_regs_index(index);
+	if (guest>=0) {
+		Bits slot=gen_regs_find(guest);
+		if (slot>=0) {
+			cache_addd( UXTH(dest_reg, REGS_CACHE_FIRST+slot) );      // uxth dest_reg, x23..x26
+			return;
+		}
+	}
 	cache_addd( LDRH_IMM(dest_reg, FC_REGS_ADDR, index) );      // ldrh dest_reg, [FC_REGS_ADDR, #index]
 }
 
 // mov 32bit value from cpu_regs[index] into dest_reg using FC_REGS_ADDR (index modulo 4 must be zero)
 static void gen_mov_regval32_to_reg(HostReg dest_reg,Bitu index) {
+	Bits guest=gen_regs_index(index);
+	if (guest>=0) {
+		Bits slot=gen_regs_find(guest);
+		if (slot>=0) {
+			cache_addd( MOV_REG_LSL_IMM(dest_reg, REGS_CACHE_FIRST+slot, 0) );      // mov dest_reg, x23..x26
+			return;
+		}
+	}
 	cache_addd( LDR_IMM(dest_reg, FC_REGS_ADDR, index) );      // ldr dest_reg, [FC_REGS_ADDR, #index]
+	if (guest>=0) cache_addd( MOV_REG_LSL_IMM(REGS_CACHE_FIRST+gen_regs_alloc(guest), dest_reg, 0) );      // mov x23..x26, dest_reg
 }
 
 // move a 32bit (dword==true) or 16bit (dword==false) value from cpu_regs[index] into dest_reg using FC_REGS_ADDR (if dword==true index modulo 4 must be zero) (if dword==false index modulo 2 must be zero)
 // 16bit moves may destroy the upper 16bit of the destination register
 static void gen_mov_regword_to_reg(HostReg dest_reg,Bitu index,bool dword) {
-	if (dword) {
-		cache_addd( LDR_IMM(dest_reg, FC_REGS_ADDR, index) );      // ldr dest_reg, [FC_REGS_ADDR, #index]
-	} else {
-		cache_addd( LDRH_IMM(dest_reg, FC_REGS_ADDR, index) );      // ldrh dest_reg, [FC_REGS_ADDR, #index]
-	}
+	if (dword) gen_mov_regval32_to_reg(dest_reg, index);
+	else gen_mov_regval16_to_reg(dest_reg, index);
 }
 
 // move an 8bit value from cpu_regs[index]  into dest_reg using FC_REGS_ADDR
@@ -1206,7 +1327,7 @@ static void gen_mov_regbyte_to_reg_low_canuseword(HostReg dest_reg,Bitu index) {
 
 // add a 32bit value from cpu_regs[index] to a full register using FC_REGS_ADDR (index modulo 4 must be zero)
 static void gen_add_regval32_to_reg(HostReg reg,Bitu index) {
-	cache_addd( LDR_IMM(temp2, FC_REGS_ADDR, index) );      // ldr temp2, [FC_REGS_ADDR, #index]
+	gen_mov_regval32_to_reg(temp2, index);
 	cache_addd( ADD_REG_LSL_IMM(reg, reg, temp2, 0) );      // add reg, reg, temp2
 }
 
@@ -1214,25 +1335,32 @@ static void gen_add_regval32_to_reg(HostReg reg,Bitu index) {
 // move 16bit of register into cpu_regs[index] using FC_REGS_ADDR (index modulo 2 must be zero)
 static void gen_mov_regval16_from_reg(HostReg src_reg,Bitu index) {
 	cache_addd( STRH_IMM(src_reg, FC_REGS_ADDR, index) );      // strh src_reg, [FC_REGS_ADDR, #index]
+	Bits guest=gen_regs_guest((Bit8u*)&cpu_regs+index);
+	if (guest>=0) gen_regs_drop(guest);
 }
 
 // move 32bit of register into cpu_regs[index] using FC_REGS_ADDR (index modulo 4 must be zero)
 static void gen_mov_regval32_from_reg(HostReg src_reg,Bitu index) {
 	cache_addd( STR_IMM(src_reg, FC_REGS_ADDR, index) );      // str src_reg, [FC_REGS_ADDR, #index]
+	Bits guest=gen_regs_index(index);
+	if (guest>=0) cache_addd( MOV_REG_LSL_IMM(REGS_CACHE_FIRST+gen_regs_alloc(guest), src_reg, 0) );      // mov x23..x26, src_reg
+	else {
+		guest=gen_regs_guest((Bit8u*)&cpu_regs+index);
+		if (guest>=0) gen_regs_drop(guest);
+	}
 }
 
 // move 32bit (dword==true) or 16bit (dword==false) of a register into cpu_regs[index] using FC_REGS_ADDR (if dword==true index modulo 4 must be zero) (if dword==false index modulo 2 must be zero)
 static void gen_mov_regword_from_reg(HostReg src_reg,Bitu index,bool dword) {
-	if (dword) {
-		cache_addd( STR_IMM(src_reg, FC_REGS_ADDR, index) );      // str src_reg, [FC_REGS_ADDR, #index]
-	} else {
-		cache_addd( STRH_IMM(src_reg, FC_REGS_ADDR, index) );      // strh src_reg, [FC_REGS_ADDR, #index]
-	}
+	if (dword) gen_mov_regval32_from_reg(src_reg, index);
+	else gen_mov_regval16_from_reg(src_reg, index);
 }
 
 // move the lowest 8bit of a register into cpu_regs[index] using FC_REGS_ADDR
 static void gen_mov_regbyte_from_reg_low(HostReg src_reg,Bitu index) {
 	cache_addd( STRB_IMM(src_reg, FC_REGS_ADDR, index) );      // strb src_reg, [FC_REGS_ADDR, #index]
+	Bits guest=gen_regs_guest((Bit8u*)&cpu_regs+index);
+	if (guest>=0) gen_regs_drop(guest);
 }
 
 #endif
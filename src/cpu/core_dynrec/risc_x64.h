@@ -81,6 +81,69 @@ typedef Bit8u HostReg;
 #define TEMP_REG_DRC HOST_ESI
 
 
+// keep 32bit guest registers in r12-r15 that are preserved across function
+// calls; stores go to cpu_regs as well so that helper functions and block
+// exits always see the current values and nothing needs to be spilled
+#define DRC_USE_REGS_CACHE
+#define REGS_CACHE_SIZE 4
+
+static struct {
+	Bits guest[REGS_CACHE_SIZE];	// guest register held by r12+i, -1 if none
+	Bitu used[REGS_CACHE_SIZE];		// when the host register was last used
+	Bitu clock;
+	bool pure_call;			// the next called function leaves the guest registers alone
+} regs_cache;
+
+// forget all cached guest registers
+static void gen_regs_reset(void) {
+	for (Bitu i=0;i<REGS_CACHE_SIZE;i++) regs_cache.guest[i]=-1;
+	regs_cache.pure_call=false;
+}
+
+// guest register that data points into, -1 for other memory
+static Bits gen_regs_guest(void* data) {
+	Bit8u* base=(Bit8u*)&cpu_regs.regs[0];
+	if (((Bit8u*)data<base) || ((Bit8u*)data>=(Bit8u*)&cpu_regs.regs[8])) return -1;
+	return (Bits)(((Bit8u*)data-base)/sizeof(cpu_regs.regs[0]));
+}
+
+// host register that holds the guest register, -1 if it is not cached
+static Bits gen_regs_find(Bits guest) {
+	for (Bitu i=0;i<REGS_CACHE_SIZE;i++) {
+		if (regs_cache.guest[i]==guest) {
+			regs_cache.used[i]=++regs_cache.clock;
+			return (Bits)i;
+		}
+	}
+	return -1;
+}
+
+// host register to hold the guest register from now on, the least
+// recently used one is taken if all of them are in use
+static Bitu gen_regs_alloc(Bits guest) {
+	Bits slot=gen_regs_find(guest);
+	if (slot>=0) return (Bitu)slot;
+	Bitu pick=0;
+	for (Bitu i=0;i<REGS_CACHE_SIZE;i++) {
+		if (regs_cache.guest[i]<0) {
+			pick=i;
+			break;
+		}
+		if (regs_cache.used[i]<regs_cache.used[pick]) pick=i;
+	}
+	regs_cache.guest[pick]=guest;
+	regs_cache.used[pick]=++regs_cache.clock;
+	return pick;
+}
+
+// the guest register in memory is changed, drop the cached copy
+static void gen_regs_drop(Bits guest) {
+	for (Bitu i=0;i<REGS_CACHE_SIZE;i++) {
+		if (regs_cache.guest[i]==guest) regs_cache.guest[i]=-1;
+	}
+}
+
+
 // move a full register from reg_src to reg_dst
 static void gen_mov_regs(HostReg reg_dst,HostReg reg_src) {
 	cache_addb(0x8b);					// mov reg_dst,reg_src
@@ -96,7 +159,7 @@ static void gen_mov_reg_qword(HostReg dest_reg,Bit64u imm) {
 
 
 // This function generates an instruction with register addressing and a memory location
-static INLINE void gen_reg_memaddr(HostReg reg,void* data,Bit8u op,Bit8u prefix=0) {
+static INLINE void gen_reg_memaddr_direct(HostReg reg,void* data,Bit8u op,Bit8u prefix=0) {
 	Bit64s diff = (Bit64s)data-((Bit64s)cache.pos+(prefix?7:6));
 //	if ((diff<0x80000000LL) && (diff>-0x80000000LL)) { //clang messes itself up on this...
 	if ( (diff>>63) == (diff>>31) ) { //signed bit extend, test to see if value fits in a Bit32s
@@ -128,8 +191,49 @@ static INLINE void gen_reg_memaddr(HostReg reg,void* data,Bit8u op,Bit8u prefix=
 	}
 }
 
+// Same as above, but takes guest registers from r12-r15 if they are cached there
+static void gen_reg_memaddr(HostReg reg,void* data,Bit8u op,Bit8u prefix=0) {
+	Bits guest=gen_regs_guest(data);
+	if (guest<0) {
+		gen_reg_memaddr_direct(reg,data,op,prefix);
+		return;
+	}
+	bool whole=(data==(void*)&cpu_regs.regs[guest]);
+	if (whole && ((op==0x8b && !prefix) || (op==0xb7 && prefix==0x0f))) {
+		Bits slot=gen_regs_find(guest);
+		if (slot>=0) {
+			if (op==0xb7) {
+				cache_addb(0x41);
+				cache_addw(0xb70f);			// movzx reg,r12w..r15w
+			} else cache_addw(0x8b41);		// mov reg,r12d..r15d
+			cache_addb(0xc4+(reg<<3)+slot);
+			return;
+		}
+		gen_reg_memaddr_direct(reg,data,op,prefix);
+		if (op==0x8b) {
+			cache_addw(0x8941);				// mov r12d..r15d,reg
+			cache_addb(0xc4+(reg<<3)+gen_regs_alloc(guest));
+		}
+		return;
+	}
+	gen_reg_memaddr_direct(reg,data,op,prefix);
+	if (op==0x89 || op==0x88) {
+		if (whole && (op==0x89) && !prefix) {
+			cache_addw(0x8941);				// mov r12d..r15d,reg
+			cache_addb(0xc4+(reg<<3)+gen_regs_alloc(guest));
+		} else {
+			gen_regs_drop(guest);
+			if (prefix & 0x08) gen_regs_drop(guest+1);	// 64bit store
+		}
+	}
+}
+
 // Same as above, but with immediate addressing and a memory location
 static INLINE void gen_memaddr(Bitu modreg,void* data,Bitu off,Bitu imm,Bit8u op,Bit8u prefix=0) {
+	// these always write to the memory location
+	Bits guest=gen_regs_guest(data);
+	if (guest>=0) gen_regs_drop(guest);
+
 	Bit64s diff = (Bit64s)data-((Bit64s)cache.pos+off+(prefix?7:6));
 //	if ((diff<0x80000000LL) && (diff>-0x80000000LL)) {
 	if ( (diff>>63) == (diff>>31) ) {
@@ -389,6 +493,10 @@ static void INLINE gen_call_function_raw(void * func) {
 //	cache_addb(0x08);	// add rsp,0x08 (reset alignment)
 	cache_addd(0x08c48348);
 #endif 
+
+	// the called function may have changed the guest registers in memory
+	if (!regs_cache.pure_call) gen_regs_reset();
+	regs_cache.pure_call=false;
 }
 
 // generate a call to a function with paramcount parameters
@@ -447,6 +555,9 @@ static Bit64u INLINE gen_call_function_setup(void * func,Bitu paramcount,bool fa
 	// restore stack
 	cache_addb(0x5c);		// pop rsp
 
+	if (!regs_cache.pure_call) gen_regs_reset();
+	regs_cache.pure_call=false;
+
 	return proc_addr;
 }
 
@@ -630,7 +741,9 @@ static void gen_fill_branch(DRC_PTR_SIZE_IM data) {
 	if (len<0) len=-len;
 	if (len>126) LOG_MSG("Big jump %d",len);
 #endif
-	*(Bit8u*)data=(Bit8u)((Bit64u)cache.pos-data-1);
+	*cache_rwptr((Bit8u*)data)=(Bit8u)((Bit64u)cache.pos-data-1);
+	// code paths join here, the cached guest registers may differ
+	gen_regs_reset();
 }
 
 // conditional jump if register is nonzero
@@ -659,12 +772,90 @@ static Bit64u gen_create_branch_long_leqzero(HostReg reg) {
 
 // calculate long relative offset and fill it into the location pointed to by data
 static void gen_fill_branch_long(Bit64u data) {
-	*(Bit32u*)data=(Bit32u)((Bit64u)cache.pos-data-4);
+	*(Bit32u*)cache_rwptr((Bit8u*)data)=(Bit32u)((Bit64u)cache.pos-data-4);
+	gen_regs_reset();
+}
+
+// unconditional jump, the destination is set by gen_fill_branch_long() later
+static Bit64u gen_create_jump_long(void) {
+	cache_addb(0xe9);		// jmp
+	cache_addd(0);
+	return ((Bit64u)cache.pos-4);
+}
+
+
+#if defined(USE_FULL_TLB)
+// memory accesses look up the host pointer in the paging tlb inline,
+// r10 and r11 are not used otherwise and serve as scratch registers
+#define DRC_USE_INLINE_TLB
+
+// look up the host pointer of the page reg_addr points into and leave it in r11,
+// the returned branch is taken if the page has no host pointer or if an access
+// of size bytes crosses the page boundary
+static Bit64u gen_tlb_lookup(HostReg reg_addr,bool write,Bitu size) {
+	cache_addw(0x8941);							// mov r10d,reg_addr
+	cache_addb(0xc2+(reg_addr<<3));
+	cache_addd(0x0ceac141);						// shr r10d,12
+	cache_addw(0xbb49);							// mov r11,tlb
+	cache_addq((Bit64u)(write ? &paging.tlb.write[0] : &paging.tlb.read[0]));
+	cache_addd(0xd31c8b4f);						// mov r11,[r11+r10*8]
+	if (size>1) {
+		cache_addw(0x8941);						// mov r10d,reg_addr
+		cache_addb(0xc2+(reg_addr<<3));
+		cache_addw(0x8141);						// and r10d,0xfff
+		cache_addb(0xe2);
+		cache_addd(0xfff);
+		cache_addw(0x8141);						// cmp r10d,0x1000-size+1
+		cache_addb(0xfa);
+		cache_addd(0x1000-size+1);
+		cache_addw(0x0372);						// jb +3
+		cache_addw(0x3145);						// xor r11d,r11d
+		cache_addb(0xdb);
+	}
+	cache_addw(0x854d);							// test r11,r11
+	cache_addb(0xdb);
+	cache_addw(0x840f);							// jz
+	cache_addd(0);
+	return ((Bit64u)cache.pos-4);
 }
 
+// fill a branch of the inline lookup, the cached guest registers stay
+// valid as neither the direct access nor the memory helpers touch them
+static void gen_fill_tlb_branch(Bit64u data) {
+	*(Bit32u*)cache_rwptr((Bit8u*)data)=(Bit32u)((Bit64u)cache.pos-data-4);
+}
+
+// read size bytes from the host page found by gen_tlb_lookup() into reg_dst
+static void gen_tlb_read(HostReg reg_addr,HostReg reg_dst,Bitu size) {
+	cache_addw(0x8941);							// mov r10d,reg_addr
+	cache_addb(0xc2+(reg_addr<<3));
+	cache_addb(0x43);
+	switch (size) {
+		case 1: cache_addw(0xb60f); break;		// movzx reg_dst,byte [r11+r10]
+		case 2: cache_addw(0xb70f); break;		// movzx reg_dst,word [r11+r10]
+		default: cache_addb(0x8b); break;		// mov reg_dst,[r11+r10]
+	}
+	cache_addb(0x04+(reg_dst<<3));
+	cache_addb(0x13);
+}
+
+// write size bytes of reg_val into the host page found by gen_tlb_lookup()
+static void gen_tlb_write(HostReg reg_addr,HostReg reg_val,Bitu size) {
+	cache_addw(0x8941);							// mov r10d,reg_addr
+	cache_addb(0xc2+(reg_addr<<3));
+	if (size==2) cache_addb(0x66);
+	cache_addb(0x43);							// the rex prefix makes the low byte of all registers accessible
+	cache_addb(size==1 ? 0x88 : 0x89);			// mov [r11+r10],reg_val
+	cache_addb(0x04+(reg_val<<3));
+	cache_addb(0x13);
+}
+#endif
+
 
 static void gen_run_code(void) {
 	cache_addb(0x53);					// push rbx
+	cache_addd(0x55415441);				// push r12; push r13
+	cache_addd(0x57415641);				// push r14; push r15
 #if defined (_WIN64)
 	cache_addw(0x5657);			// push rdi; push rsi
 #endif
@@ -672,6 +863,8 @@ static void gen_run_code(void) {
 #if defined (_WIN64)
 	cache_addw(0x5f5e);			// pop rsi; pop rdi
 #endif
+	cache_addd(0x5e415f41);				// pop r15; pop r14
+	cache_addd(0x5c415d41);				// pop r13; pop r12
 	cache_addb(0x5b);					// pop  rbx
 }
 
@@ -686,6 +879,7 @@ static void gen_return_function(void) {
 // check gen_call_function_raw and gen_call_function_setup
 // for the targeted code
 static void gen_fill_function_ptr(Bit8u * pos,void* fct_ptr,Bitu flags_type) {
+	pos=cache_rwptr(pos);
 #ifdef DRC_FLAGS_INVALIDATION_DCODE
 	// try to avoid function calls but rather directly fill in code
 	switch (flags_type) {
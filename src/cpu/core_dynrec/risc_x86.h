@@ -390,7 +390,7 @@ static void gen_fill_branch(DRC_PTR_SIZE_IM data) {
 	if (len<0) len=-len;
 	if (len>126) LOG_MSG("Big jump %d",len);
 #endif
-	*(Bit8u*)data=(Bit8u)((Bit32u)cache.pos-data-1);
+	*cache_rwptr((Bit8u*)data)=(Bit8u)((Bit32u)cache.pos-data-1);
 }
 
 // conditional jump if register is nonzero
@@ -419,7 +419,7 @@ static Bit32u gen_create_branch_long_leqzero(HostReg reg) {
 
 // calculate long relative offset and fill it into the location pointed to by data
 static void gen_fill_branch_long(Bit32u data) {
-	*(Bit32u*)data=((Bit32u)cache.pos-data-4);
+	*(Bit32u*)cache_rwptr((Bit8u*)data)=((Bit32u)cache.pos-data-4);
 }
 
 
@@ -441,6 +441,8 @@ static void gen_return_function(void) {
 // called when a call to a function can be replaced by a
 // call to a simpler function
 static void gen_fill_function_ptr(Bit8u * pos,void* fct_ptr,Bitu flags_type) {
+	Bit8u * call_pos=pos;	// the call is relative to the executable location
+	pos=cache_rwptr(pos);
 #ifdef DRC_FLAGS_INVALIDATION_DCODE
 	// try to avoid function calls but rather directly fill in code
 	switch (flags_type) {
@@ -502,11 +504,11 @@ static void gen_fill_function_ptr(Bit8u * pos,void* fct_ptr,Bitu flags_type) {
 			*(pos+4)=0x90;
 			break;
 		default:
-			*(Bit32u*)(pos+1)=(Bit32u)((Bit8u*)fct_ptr - (pos+1+4));	// fill function pointer
+			*(Bit32u*)(pos+1)=(Bit32u)((Bit8u*)fct_ptr - (call_pos+1+4));	// fill function pointer
 			break;
 	}
 #else
-	*(Bit32u*)(pos+1)=(Bit32u)((Bit8u*)fct_ptr - (pos+1+4));	// fill function pointer
+	*(Bit32u*)(pos+1)=(Bit32u)((Bit8u*)fct_ptr - (call_pos+1+4));	// fill function pointer
 #endif
 }
 #endif
@@ -138,25 +138,82 @@ static INLINE Bit32u Fetchd() {
 
 #define EALookupTable (core.ea_table)
 
-Bits CPU_Core_Normal_Run(void) {
-	while (CPU_Cycles-->0) {
-		LOADIP;
-		core.opcode_index=cpu.code.big*0x200;
-		core.prefixes=cpu.code.big;
-		core.ea_table=&EATable[cpu.code.big*256];
-		BaseDS=SegBase(ds);
-		BaseSS=SegBase(ss);
-		core.base_val_ds=ds;
-#if C_DEBUG
-#if C_HEAVY_DEBUG
-		if (DEBUG_HeavyIsBreakpoint()) {
-			FillFlags();
-			return debugCallback;
-		};
+/* Sets up the decoding state for the next instruction */
+#if C_DEBUG && C_HEAVY_DEBUG
+#define CORE_DEBUG_CHECK										\
+	if (DEBUG_HeavyIsBreakpoint()) {							\
+		FillFlags();											\
+		return debugCallback;									\
+	}															\
+	cycle_count++;
+#elif C_DEBUG
+#define CORE_DEBUG_CHECK cycle_count++;
+#else
+#define CORE_DEBUG_CHECK
+#endif
+
+#define CORE_START_OPCODE										\
+	LOADIP;														\
+	core.opcode_index=cpu.code.big*0x200;						\
+	core.prefixes=cpu.code.big;									\
+	core.ea_table=&EATable[cpu.code.big*256];					\
+	BaseDS=SegBase(ds);											\
+	BaseSS=SegBase(ss);											\
+	core.base_val_ds=ds;										\
+	CORE_DEBUG_CHECK
+
+/* Threaded dispatch: every handler ends with its own jump to the next opcode
+ * through a table of label addresses, so the branch predictor sees one
+ * indirect jump per handler instead of the single one of the switch. This
+ * needs the labels as values extension of gcc and clang. Breaks and continues
+ * that are left in the handlers and macros still go through the loop. */
+#if C_CORE_THREADED && defined(__GNUC__)
+#define CORE_THREADED 1
+
+#undef NEXT_OPCODE
+#undef NEXT_JUMP
+
+#define NEXT_OPCODE {											\
+	SAVEIP;														\
+	NEXT_JUMP;													\
+}
+
+#define NEXT_JUMP {												\
+	if (GCC_UNLIKELY(CPU_Cycles--<=0)) goto cycles_end;			\
+	CORE_START_OPCODE											\
+	goto *opcode_labels[core.opcode_index+Fetchb()];			\
+}
+
+#undef CASE_W
+#undef CASE_D
+#undef CASE_0F_W
+#undef CASE_0F_D
+
+#define CASE_W(_WHICH)							\
+	case (OPCODE_NONE+_WHICH): op_w_ ## _WHICH:
+
+#define CASE_D(_WHICH)							\
+	case (OPCODE_SIZE+_WHICH): op_d_ ## _WHICH:
+
+#define CASE_0F_W(_WHICH)						\
+	case ((OPCODE_0F|OPCODE_NONE)+_WHICH): op_0fw_ ## _WHICH:
+
+#define CASE_0F_D(_WHICH)						\
+	case ((OPCODE_0F|OPCODE_SIZE)+_WHICH): op_0fd_ ## _WHICH:
 #endif
-		cycle_count++;
+
+Bits CPU_Core_Normal_Run(void) {
+#if CORE_THREADED
+	static const void * const opcode_labels[0x400]={
+		#include "core_normal/table_threaded.h"
+	};
 #endif
+	while (CPU_Cycles-->0) {
+		CORE_START_OPCODE
 restart_opcode:
+#if CORE_THREADED
+		goto *opcode_labels[core.opcode_index+Fetchb()];
+#endif
 		switch (core.opcode_index+Fetchb()) {
 		#include "core_normal/prefix_none.h"
 		#include "core_normal/prefix_0f.h"
@@ -182,6 +239,9 @@ restart_opcode:
 		}
 		SAVEIP;
 	}
+#if CORE_THREADED
+cycles_end:
+#endif
 	FillFlags();
 	return CBRET_NONE;
 decode_end:
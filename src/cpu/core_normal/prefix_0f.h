@@ -58,7 +58,7 @@
 				goto illegal_opcode;
 			}
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_W(0x01)												/* Group 7 Ew */
 		{
 			GetRM;Bitu which=(rm>>3)&7;
@@ -113,7 +113,7 @@
 				}
 			}
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_W(0x02)												/* LAR Gw,Ew */
 		{
 			if ((reg_flags & FLAG_VM) || (!cpu.pmode)) goto illegal_opcode;
@@ -125,7 +125,7 @@
 			}
 			*rmrw=(Bit16u)ar;
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_W(0x03)												/* LSL Gw,Ew */
 		{
 			if ((reg_flags & FLAG_VM) || (!cpu.pmode)) goto illegal_opcode;
@@ -137,16 +137,16 @@
 			}
 			*rmrw=(Bit16u)limit;
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_B(0x06)												/* CLTS */
 		if (cpu.pmode && cpu.cpl) EXCEPTION(EXCEPTION_GP);
 		cpu.cr0&=(~CR0_TASKSWITCH);
-		break;
+		NEXT_OPCODE;
 	CASE_0F_B(0x08)												/* INVD */
 	CASE_0F_B(0x09)												/* WBINVD */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
 		if (cpu.pmode && cpu.cpl) EXCEPTION(EXCEPTION_GP);
-		break;
+		NEXT_OPCODE;
 	CASE_0F_B(0x20)												/* MOV Rd.CRx */
 		{
 			GetRM;
@@ -160,7 +160,7 @@
 			if (CPU_READ_CRX(which,crx_value)) RUNEXCEPTION();
 			*eard=crx_value;
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_B(0x21)												/* MOV Rd,DRx */
 		{
 			GetRM;
@@ -174,7 +174,7 @@
 			if (CPU_READ_DRX(which,drx_value)) RUNEXCEPTION();
 			*eard=drx_value;
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_B(0x22)												/* MOV CRx,Rd */
 		{
 			GetRM;
@@ -186,7 +186,7 @@
 			GetEArd;
 			if (CPU_WRITE_CRX(which,*eard)) RUNEXCEPTION();
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_B(0x23)												/* MOV DRx,Rd */
 		{
 			GetRM;
@@ -198,7 +198,7 @@
 			GetEArd;
 			if (CPU_WRITE_DRX(which,*eard)) RUNEXCEPTION();
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_B(0x24)												/* MOV Rd,TRx */
 		{
 			GetRM;
@@ -212,7 +212,7 @@
 			if (CPU_READ_TRX(which,trx_value)) RUNEXCEPTION();
 			*eard=trx_value;
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_B(0x26)												/* MOV TRx,Rd */
 		{
 			GetRM;
@@ -224,7 +224,7 @@
 			GetEArd;
 			if (CPU_WRITE_TRX(which,*eard)) RUNEXCEPTION();
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_B(0x31)												/* RDTSC */
 		{
 			if (CPU_ArchitectureType<CPU_ARCHTYPE_PENTIUMSLOW) goto illegal_opcode;
@@ -233,80 +233,80 @@
 			reg_edx=(Bit32u)(tsc>>32);
 			reg_eax=(Bit32u)(tsc&0xffffffff);
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_W(0x80)												/* JO */
-		JumpCond16_w(TFLG_O);break;
+		JumpCond16_w(TFLG_O);NEXT_OPCODE;
 	CASE_0F_W(0x81)												/* JNO */
-		JumpCond16_w(TFLG_NO);break;
+		JumpCond16_w(TFLG_NO);NEXT_OPCODE;
 	CASE_0F_W(0x82)												/* JB */
-		JumpCond16_w(TFLG_B);break;
+		JumpCond16_w(TFLG_B);NEXT_OPCODE;
 	CASE_0F_W(0x83)												/* JNB */
-		JumpCond16_w(TFLG_NB);break;
+		JumpCond16_w(TFLG_NB);NEXT_OPCODE;
 	CASE_0F_W(0x84)												/* JZ */
-		JumpCond16_w(TFLG_Z);break;
+		JumpCond16_w(TFLG_Z);NEXT_OPCODE;
 	CASE_0F_W(0x85)												/* JNZ */
-		JumpCond16_w(TFLG_NZ);break;
+		JumpCond16_w(TFLG_NZ);NEXT_OPCODE;
 	CASE_0F_W(0x86)												/* JBE */
-		JumpCond16_w(TFLG_BE);break;
+		JumpCond16_w(TFLG_BE);NEXT_OPCODE;
 	CASE_0F_W(0x87)												/* JNBE */
-		JumpCond16_w(TFLG_NBE);break;
+		JumpCond16_w(TFLG_NBE);NEXT_OPCODE;
 	CASE_0F_W(0x88)												/* JS */
-		JumpCond16_w(TFLG_S);break;
+		JumpCond16_w(TFLG_S);NEXT_OPCODE;
 	CASE_0F_W(0x89)												/* JNS */
-		JumpCond16_w(TFLG_NS);break;
+		JumpCond16_w(TFLG_NS);NEXT_OPCODE;
 	CASE_0F_W(0x8a)												/* JP */
-		JumpCond16_w(TFLG_P);break;
+		JumpCond16_w(TFLG_P);NEXT_OPCODE;
 	CASE_0F_W(0x8b)												/* JNP */
-		JumpCond16_w(TFLG_NP);break;
+		JumpCond16_w(TFLG_NP);NEXT_OPCODE;
 	CASE_0F_W(0x8c)												/* JL */
-		JumpCond16_w(TFLG_L);break;
+		JumpCond16_w(TFLG_L);NEXT_OPCODE;
 	CASE_0F_W(0x8d)												/* JNL */
-		JumpCond16_w(TFLG_NL);break;
+		JumpCond16_w(TFLG_NL);NEXT_OPCODE;
 	CASE_0F_W(0x8e)												/* JLE */
-		JumpCond16_w(TFLG_LE);break;
+		JumpCond16_w(TFLG_LE);NEXT_OPCODE;
 	CASE_0F_W(0x8f)												/* JNLE */
-		JumpCond16_w(TFLG_NLE);break;
+		JumpCond16_w(TFLG_NLE);NEXT_OPCODE;
 	CASE_0F_B(0x90)												/* SETO */
-		SETcc(TFLG_O);break;
+		SETcc(TFLG_O);NEXT_OPCODE;
 	CASE_0F_B(0x91)												/* SETNO */
-		SETcc(TFLG_NO);break;
+		SETcc(TFLG_NO);NEXT_OPCODE;
 	CASE_0F_B(0x92)												/* SETB */
-		SETcc(TFLG_B);break;
+		SETcc(TFLG_B);NEXT_OPCODE;
 	CASE_0F_B(0x93)												/* SETNB */
-		SETcc(TFLG_NB);break;
+		SETcc(TFLG_NB);NEXT_OPCODE;
 	CASE_0F_B(0x94)												/* SETZ */
-		SETcc(TFLG_Z);break;
+		SETcc(TFLG_Z);NEXT_OPCODE;
 	CASE_0F_B(0x95)												/* SETNZ */
-		SETcc(TFLG_NZ);	break;
+		SETcc(TFLG_NZ);	NEXT_OPCODE;
 	CASE_0F_B(0x96)												/* SETBE */
-		SETcc(TFLG_BE);break;
+		SETcc(TFLG_BE);NEXT_OPCODE;
 	CASE_0F_B(0x97)												/* SETNBE */
-		SETcc(TFLG_NBE);break;
+		SETcc(TFLG_NBE);NEXT_OPCODE;
 	CASE_0F_B(0x98)												/* SETS */
-		SETcc(TFLG_S);break;
+		SETcc(TFLG_S);NEXT_OPCODE;
 	CASE_0F_B(0x99)												/* SETNS */
-		SETcc(TFLG_NS);break;
+		SETcc(TFLG_NS);NEXT_OPCODE;
 	CASE_0F_B(0x9a)												/* SETP */
-		SETcc(TFLG_P);break;
+		SETcc(TFLG_P);NEXT_OPCODE;
 	CASE_0F_B(0x9b)												/* SETNP */
-		SETcc(TFLG_NP);break;
+		SETcc(TFLG_NP);NEXT_OPCODE;
 	CASE_0F_B(0x9c)												/* SETL */
-		SETcc(TFLG_L);break;
+		SETcc(TFLG_L);NEXT_OPCODE;
 	CASE_0F_B(0x9d)												/* SETNL */
-		SETcc(TFLG_NL);break;
+		SETcc(TFLG_NL);NEXT_OPCODE;
 	CASE_0F_B(0x9e)												/* SETLE */
-		SETcc(TFLG_LE);break;
+		SETcc(TFLG_LE);NEXT_OPCODE;
 	CASE_0F_B(0x9f)												/* SETNLE */
-		SETcc(TFLG_NLE);break;
+		SETcc(TFLG_NLE);NEXT_OPCODE;
 
 	CASE_0F_W(0xa0)												/* PUSH FS */		
-		Push_16(SegValue(fs));break;
+		Push_16(SegValue(fs));NEXT_OPCODE;
 	CASE_0F_W(0xa1)												/* POP FS */	
 		if (CPU_PopSeg(fs,false)) RUNEXCEPTION();
-		break;
+		NEXT_OPCODE;
 	CASE_0F_B(0xa2)												/* CPUID */
 		if (!CPU_CPUID()) goto illegal_opcode;
-		break;
+		NEXT_OPCODE;
 	CASE_0F_W(0xa3)												/* BT Ew,Gw */
 		{
 			FillFlags();GetRMrw;
@@ -319,19 +319,19 @@
 				Bit16u old=LoadMw(eaa);
 				SETFLAGBIT(CF,(old & mask));
 			}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xa4)												/* SHLD Ew,Gw,Ib */
 		RMEwGwOp3(DSHLW,Fetchb());
-		break;
+		NEXT_OPCODE;
 	CASE_0F_W(0xa5)												/* SHLD Ew,Gw,CL */
 		RMEwGwOp3(DSHLW,reg_cl);
-		break;
+		NEXT_OPCODE;
 	CASE_0F_W(0xa8)												/* PUSH GS */		
-		Push_16(SegValue(gs));break;
+		Push_16(SegValue(gs));NEXT_OPCODE;
 	CASE_0F_W(0xa9)												/* POP GS */		
 		if (CPU_PopSeg(gs,false)) RUNEXCEPTION();
-		break;
+		NEXT_OPCODE;
 	CASE_0F_W(0xab)												/* BTS Ew,Gw */
 		{
 			FillFlags();GetRMrw;
@@ -346,17 +346,17 @@
 				SETFLAGBIT(CF,(old & mask));
 				SaveMw(eaa,old | mask);
 			}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xac)												/* SHRD Ew,Gw,Ib */
 		RMEwGwOp3(DSHRW,Fetchb());
-		break;
+		NEXT_OPCODE;
 	CASE_0F_W(0xad)												/* SHRD Ew,Gw,CL */
 		RMEwGwOp3(DSHRW,reg_cl);
-		break;
+		NEXT_OPCODE;
 	CASE_0F_W(0xaf)												/* IMUL Gw,Ew */
 		RMGwEwOp3(DIMULW,*rmrw);
-		break;
+		NEXT_OPCODE;
 	CASE_0F_B(0xb0) 										/* cmpxchg Eb,Gb */
 		{
 			if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
@@ -383,7 +383,7 @@
 					SETFLAGBIT(ZF,0);
 				}
 			}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xb1) 									/* cmpxchg Ew,Gw */
 		{
@@ -411,7 +411,7 @@
 					SETFLAGBIT(ZF,0);
 				}
 			}
-			break;
+			NEXT_OPCODE;
 		}
 
 	CASE_0F_W(0xb2)												/* LSS Ew */
@@ -421,7 +421,7 @@
 			GetEAa;
 			if (CPU_SetSegGeneral(ss,LoadMw(eaa+2))) RUNEXCEPTION();
 			*rmrw=LoadMw(eaa);
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xb3)												/* BTR Ew,Gw */
 		{
@@ -437,7 +437,7 @@
 				SETFLAGBIT(CF,(old & mask));
 				SaveMw(eaa,old & ~mask);
 			}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xb4)												/* LFS Ew */
 		{	
@@ -446,7 +446,7 @@
 			GetEAa;
 			if (CPU_SetSegGeneral(fs,LoadMw(eaa+2))) RUNEXCEPTION();
 			*rmrw=LoadMw(eaa);
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xb5)												/* LGS Ew */
 		{	
@@ -455,14 +455,14 @@
 			GetEAa;
 			if (CPU_SetSegGeneral(gs,LoadMw(eaa+2))) RUNEXCEPTION();
 			*rmrw=LoadMw(eaa);
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xb6)												/* MOVZX Gw,Eb */
 		{
 			GetRMrw;															
 			if (rm >= 0xc0 ) {GetEArb;*rmrw=*earb;}
 			else {GetEAa;*rmrw=LoadMb(eaa);}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xb7)												/* MOVZX Gw,Ew */
 	CASE_0F_W(0xbf)												/* MOVSX Gw,Ew */
@@ -470,7 +470,7 @@
 			GetRMrw;															
 			if (rm >= 0xc0 ) {GetEArw;*rmrw=*earw;}
 			else {GetEAa;*rmrw=LoadMw(eaa);}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xba)												/* GRP8 Ew,Ib */
 		{
@@ -514,7 +514,7 @@
 					E_Exit("CPU:0F:BA:Illegal subfunction %X",rm & 0x38);
 				}
 			}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xbb)												/* BTC Ew,Gw */
 		{
@@ -530,7 +530,7 @@
 				SETFLAGBIT(CF,(old & mask));
 				SaveMw(eaa,old ^ mask);
 			}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xbc)												/* BSF Gw,Ew */
 		{
@@ -547,7 +547,7 @@
 				*rmrw = result;
 			}
 			lflags.type=t_UNKNOWN;
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xbd)												/* BSR Gw,Ew */
 		{
@@ -564,14 +564,14 @@
 				*rmrw = result;
 			}
 			lflags.type=t_UNKNOWN;
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xbe)												/* MOVSX Gw,Eb */
 		{
 			GetRMrw;															
 			if (rm >= 0xc0 ) {GetEArb;*rmrw=*(Bit8s *)earb;}
 			else {GetEAa;*rmrw=LoadMbs(eaa);}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_B(0xc0)												/* XADD Gb,Eb */
 		{
@@ -579,7 +579,7 @@
 			GetRMrb;Bit8u oldrmrb=*rmrb;
 			if (rm >= 0xc0 ) {GetEArb;*rmrb=*earb;*earb+=oldrmrb;}
 			else {GetEAa;*rmrb=LoadMb(eaa);SaveMb(eaa,LoadMb(eaa)+oldrmrb);}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xc1)												/* XADD Gw,Ew */
 		{
@@ -587,30 +587,30 @@
 			GetRMrw;Bit16u oldrmrw=*rmrw;
 			if (rm >= 0xc0 ) {GetEArw;*rmrw=*earw;*earw+=oldrmrw;}
 			else {GetEAa;*rmrw=LoadMw(eaa);SaveMw(eaa,LoadMw(eaa)+oldrmrw);}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_W(0xc8)												/* BSWAP AX */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPW(reg_ax);break;
+		BSWAPW(reg_ax);NEXT_OPCODE;
 	CASE_0F_W(0xc9)												/* BSWAP CX */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPW(reg_cx);break;
+		BSWAPW(reg_cx);NEXT_OPCODE;
 	CASE_0F_W(0xca)												/* BSWAP DX */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPW(reg_dx);break;
+		BSWAPW(reg_dx);NEXT_OPCODE;
 	CASE_0F_W(0xcb)												/* BSWAP BX */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPW(reg_bx);break;
+		BSWAPW(reg_bx);NEXT_OPCODE;
 	CASE_0F_W(0xcc)												/* BSWAP SP */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPW(reg_sp);break;
+		BSWAPW(reg_sp);NEXT_OPCODE;
 	CASE_0F_W(0xcd)												/* BSWAP BP */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPW(reg_bp);break;
+		BSWAPW(reg_bp);NEXT_OPCODE;
 	CASE_0F_W(0xce)												/* BSWAP SI */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPW(reg_si);break;
+		BSWAPW(reg_si);NEXT_OPCODE;
 	CASE_0F_W(0xcf)												/* BSWAP DI */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPW(reg_di);break;
+		BSWAPW(reg_di);NEXT_OPCODE;
 		
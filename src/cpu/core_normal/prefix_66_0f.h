@@ -60,7 +60,7 @@
 				goto illegal_opcode;
 			}
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_D(0x01)												/* Group 7 Ed */
 		{
 			GetRM;Bitu which=(rm>>3)&7;
@@ -118,7 +118,7 @@
 
 			}
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_D(0x02)												/* LAR Gd,Ed */
 		{
 			if ((reg_flags & FLAG_VM) || (!cpu.pmode)) goto illegal_opcode;
@@ -130,7 +130,7 @@
 			}
 			*rmrd=(Bit32u)ar;
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_D(0x03)												/* LSL Gd,Ew */
 		{
 			if ((reg_flags & FLAG_VM) || (!cpu.pmode)) goto illegal_opcode;
@@ -143,45 +143,45 @@
 			}
 			*rmrd=(Bit32u)limit;
 		}
-		break;
+		NEXT_OPCODE;
 	CASE_0F_D(0x80)												/* JO */
-		JumpCond32_d(TFLG_O);break;
+		JumpCond32_d(TFLG_O);NEXT_OPCODE;
 	CASE_0F_D(0x81)												/* JNO */
-		JumpCond32_d(TFLG_NO);break;
+		JumpCond32_d(TFLG_NO);NEXT_OPCODE;
 	CASE_0F_D(0x82)												/* JB */
-		JumpCond32_d(TFLG_B);break;
+		JumpCond32_d(TFLG_B);NEXT_OPCODE;
 	CASE_0F_D(0x83)												/* JNB */
-		JumpCond32_d(TFLG_NB);break;
+		JumpCond32_d(TFLG_NB);NEXT_OPCODE;
 	CASE_0F_D(0x84)												/* JZ */
-		JumpCond32_d(TFLG_Z);break;
+		JumpCond32_d(TFLG_Z);NEXT_OPCODE;
 	CASE_0F_D(0x85)												/* JNZ */
-		JumpCond32_d(TFLG_NZ);break;
+		JumpCond32_d(TFLG_NZ);NEXT_OPCODE;
 	CASE_0F_D(0x86)												/* JBE */
-		JumpCond32_d(TFLG_BE);break;
+		JumpCond32_d(TFLG_BE);NEXT_OPCODE;
 	CASE_0F_D(0x87)												/* JNBE */
-		JumpCond32_d(TFLG_NBE);break;
+		JumpCond32_d(TFLG_NBE);NEXT_OPCODE;
 	CASE_0F_D(0x88)												/* JS */
-		JumpCond32_d(TFLG_S);break;
+		JumpCond32_d(TFLG_S);NEXT_OPCODE;
 	CASE_0F_D(0x89)												/* JNS */
-		JumpCond32_d(TFLG_NS);break;
+		JumpCond32_d(TFLG_NS);NEXT_OPCODE;
 	CASE_0F_D(0x8a)												/* JP */
-		JumpCond32_d(TFLG_P);break;
+		JumpCond32_d(TFLG_P);NEXT_OPCODE;
 	CASE_0F_D(0x8b)												/* JNP */
-		JumpCond32_d(TFLG_NP);break;
+		JumpCond32_d(TFLG_NP);NEXT_OPCODE;
 	CASE_0F_D(0x8c)												/* JL */
-		JumpCond32_d(TFLG_L);break;
+		JumpCond32_d(TFLG_L);NEXT_OPCODE;
 	CASE_0F_D(0x8d)												/* JNL */
-		JumpCond32_d(TFLG_NL);break;
+		JumpCond32_d(TFLG_NL);NEXT_OPCODE;
 	CASE_0F_D(0x8e)												/* JLE */
-		JumpCond32_d(TFLG_LE);break;
+		JumpCond32_d(TFLG_LE);NEXT_OPCODE;
 	CASE_0F_D(0x8f)												/* JNLE */
-		JumpCond32_d(TFLG_NLE);break;
+		JumpCond32_d(TFLG_NLE);NEXT_OPCODE;
 	
 	CASE_0F_D(0xa0)												/* PUSH FS */		
-		Push_32(SegValue(fs));break;
+		Push_32(SegValue(fs));NEXT_OPCODE;
 	CASE_0F_D(0xa1)												/* POP FS */		
 		if (CPU_PopSeg(fs,true)) RUNEXCEPTION();
-		break;
+		NEXT_OPCODE;
 	CASE_0F_D(0xa3)												/* BT Ed,Gd */
 		{
 			FillFlags();GetRMrd;
@@ -194,19 +194,19 @@
 				Bit32u old=LoadMd(eaa);
 				SETFLAGBIT(CF,(old & mask));
 			}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xa4)												/* SHLD Ed,Gd,Ib */
 		RMEdGdOp3(DSHLD,Fetchb());
-		break;
+		NEXT_OPCODE;
 	CASE_0F_D(0xa5)												/* SHLD Ed,Gd,CL */
 		RMEdGdOp3(DSHLD,reg_cl);
-		break;
+		NEXT_OPCODE;
 	CASE_0F_D(0xa8)												/* PUSH GS */		
-		Push_32(SegValue(gs));break;
+		Push_32(SegValue(gs));NEXT_OPCODE;
 	CASE_0F_D(0xa9)												/* POP GS */		
 		if (CPU_PopSeg(gs,true)) RUNEXCEPTION();
-		break;
+		NEXT_OPCODE;
 	CASE_0F_D(0xab)												/* BTS Ed,Gd */
 		{
 			FillFlags();GetRMrd;
@@ -221,19 +221,19 @@
 				SETFLAGBIT(CF,(old & mask));
 				SaveMd(eaa,old | mask);
 			}
-			break;
+			NEXT_OPCODE;
 		}
 	
 	CASE_0F_D(0xac)												/* SHRD Ed,Gd,Ib */
 		RMEdGdOp3(DSHRD,Fetchb());
-		break;
+		NEXT_OPCODE;
 	CASE_0F_D(0xad)												/* SHRD Ed,Gd,CL */
 		RMEdGdOp3(DSHRD,reg_cl);
-		break;
+		NEXT_OPCODE;
 	CASE_0F_D(0xaf)												/* IMUL Gd,Ed */
 		{
 			RMGdEdOp3(DIMULD,*rmrd);
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xb1)												/* CMPXCHG Ed,Gd */
 		{	
@@ -261,7 +261,7 @@
 					SETFLAGBIT(ZF,0);
 				}
 			}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xb2)												/* LSS Ed */
 		{	
@@ -270,7 +270,7 @@
 			GetEAa;
 			if (CPU_SetSegGeneral(ss,LoadMw(eaa+4))) RUNEXCEPTION();
 			*rmrd=LoadMd(eaa);
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xb3)												/* BTR Ed,Gd */
 		{
@@ -286,7 +286,7 @@
 				SETFLAGBIT(CF,(old & mask));
 				SaveMd(eaa,old & ~mask);
 			}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xb4)												/* LFS Ed */
 		{	
@@ -295,7 +295,7 @@
 			GetEAa;
 			if (CPU_SetSegGeneral(fs,LoadMw(eaa+4))) RUNEXCEPTION();
 			*rmrd=LoadMd(eaa);
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xb5)												/* LGS Ed */
 		{	
@@ -304,21 +304,21 @@
 			GetEAa;
 			if (CPU_SetSegGeneral(gs,LoadMw(eaa+4))) RUNEXCEPTION();
 			*rmrd=LoadMd(eaa);
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xb6)												/* MOVZX Gd,Eb */
 		{
 			GetRMrd;															
 			if (rm >= 0xc0 ) {GetEArb;*rmrd=*earb;}
 			else {GetEAa;*rmrd=LoadMb(eaa);}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xb7)												/* MOVXZ Gd,Ew */
 		{
 			GetRMrd;
 			if (rm >= 0xc0 ) {GetEArw;*rmrd=*earw;}
 			else {GetEAa;*rmrd=LoadMw(eaa);}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xba)												/* GRP8 Ed,Ib */
 		{
@@ -365,7 +365,7 @@
 					E_Exit("CPU:66:0F:BA:Illegal subfunction %X",rm & 0x38);
 				}
 			}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xbb)												/* BTC Ed,Gd */
 		{
@@ -381,7 +381,7 @@
 				SETFLAGBIT(CF,(old & mask));
 				SaveMd(eaa,old ^ mask);
 			}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xbc)												/* BSF Gd,Ed */
 		{
@@ -398,7 +398,7 @@
 				*rmrd = result;
 			}
 			lflags.type=t_UNKNOWN;
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xbd)												/*  BSR Gd,Ed */
 		{
@@ -415,21 +415,21 @@
 				*rmrd = result;
 			}
 			lflags.type=t_UNKNOWN;
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xbe)												/* MOVSX Gd,Eb */
 		{
 			GetRMrd;															
 			if (rm >= 0xc0 ) {GetEArb;*rmrd=*(Bit8s *)earb;}
 			else {GetEAa;*rmrd=LoadMbs(eaa);}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xbf)												/* MOVSX Gd,Ew */
 		{
 			GetRMrd;															
 			if (rm >= 0xc0 ) {GetEArw;*rmrd=*(Bit16s *)earw;}
 			else {GetEAa;*rmrd=LoadMws(eaa);}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xc1)												/* XADD Gd,Ed */
 		{
@@ -437,29 +437,29 @@
 			GetRMrd;Bit32u oldrmrd=*rmrd;
 			if (rm >= 0xc0 ) {GetEArd;*rmrd=*eard;*eard+=oldrmrd;}
 			else {GetEAa;*rmrd=LoadMd(eaa);SaveMd(eaa,LoadMd(eaa)+oldrmrd);}
-			break;
+			NEXT_OPCODE;
 		}
 	CASE_0F_D(0xc8)												/* BSWAP EAX */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPD(reg_eax);break;
+		BSWAPD(reg_eax);NEXT_OPCODE;
 	CASE_0F_D(0xc9)												/* BSWAP ECX */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPD(reg_ecx);break;
+		BSWAPD(reg_ecx);NEXT_OPCODE;
 	CASE_0F_D(0xca)												/* BSWAP EDX */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPD(reg_edx);break;
+		BSWAPD(reg_edx);NEXT_OPCODE;
 	CASE_0F_D(0xcb)												/* BSWAP EBX */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPD(reg_ebx);break;
+		BSWAPD(reg_ebx);NEXT_OPCODE;
 	CASE_0F_D(0xcc)												/* BSWAP ESP */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPD(reg_esp);break;
+		BSWAPD(reg_esp);NEXT_OPCODE;
 	CASE_0F_D(0xcd)												/* BSWAP EBP */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPD(reg_ebp);break;
+		BSWAPD(reg_ebp);NEXT_OPCODE;
 	CASE_0F_D(0xce)												/* BSWAP ESI */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPD(reg_esi);break;
+		BSWAPD(reg_esi);NEXT_OPCODE;
 	CASE_0F_D(0xcf)												/* BSWAP EDI */
 		if (CPU_ArchitectureType<CPU_ARCHTYPE_486OLDSLOW) goto illegal_opcode;
-		BSWAPD(reg_edi);break;
+		BSWAPD(reg_edi);NEXT_OPCODE;
@@ -41,6 +41,12 @@ static INLINE Bit32s Fetchds() {
 }
 
 
+/* End of an opcode handler, break when the instruction pointer still is
+ * in core.cseip, continue when reg_eip was set. The threaded normal core
+ * redefines these to dispatch the next opcode right away. */
+#define NEXT_OPCODE break
+#define NEXT_JUMP continue
+
 #define RUNEXCEPTION() {										\
 	CPU_Exception(cpu.exception.which,cpu.exception.error);		\
 	continue;													\
@@ -57,28 +63,28 @@ static INLINE Bit32s Fetchds() {
 	SAVEIP;											\
 	if (COND) reg_ip+=Fetchbs();					\
 	reg_ip+=1;										\
-	continue;										\
+	NEXT_JUMP;										\
 }
 
 #define JumpCond16_w(COND) {						\
 	SAVEIP;											\
 	if (COND) reg_ip+=Fetchws();					\
 	reg_ip+=2;										\
-	continue;										\
+	NEXT_JUMP;										\
 }
 
 #define JumpCond32_b(COND) {						\
 	SAVEIP;											\
 	if (COND) reg_eip+=Fetchbs();					\
 	reg_eip+=1;										\
-	continue;										\
+	NEXT_JUMP;										\
 }
 
 #define JumpCond32_d(COND) {						\
 	SAVEIP;											\
 	if (COND) reg_eip+=Fetchds();					\
 	reg_eip+=4;										\
-	continue;										\
+	NEXT_JUMP;										\
 }
 
 
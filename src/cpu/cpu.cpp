@@ -80,6 +80,8 @@ void CPU_Core_Dyn_X86_SetFPUMode(bool dh_fpu);
 void CPU_Core_Dynrec_Init(void);
 void CPU_Core_Dynrec_Cache_Init(bool enable_cache);
 void CPU_Core_Dynrec_Cache_Close(void);
+void CPU_Core_Dynrec_Cache_Size(Bitu megabytes);
+void CPU_Core_Dynrec_SetFlagsMode(bool optimize);
 #endif
 
 /* In debug mode exceptions are tested and dosbox exits when 
@@ -2353,7 +2355,9 @@ public:
 #if (C_DYNAMIC_X86)
 		CPU_Core_Dyn_X86_Cache_Init((core == "dynamic") || (core == "dynamic_nodhfpu"));
 #elif (C_DYNREC)
+		CPU_Core_Dynrec_Cache_Size(section->Get_int("dynamic_cache"));
 		CPU_Core_Dynrec_Cache_Init( core == "dynamic" );
+		CPU_Core_Dynrec_SetFlagsMode(section->Get_bool("dynamic_flags"));
 #endif
 
 		CPU_ArchitectureType = CPU_ARCHTYPE_MIXED;
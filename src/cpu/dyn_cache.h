@@ -0,0 +1,102 @@
+/*
+ *  Copyright (C) 2002-2019  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+	Code cache memory shared by the dynamic cores.
+
+	The cache is normally one block of memory that is writable and
+	executable at the same time. Hosts that enforce W^X (SELinux execmem,
+	PaX mprotect) refuse that, in which case the same memory object is
+	mapped twice: once executable, once writable. All addresses handed
+	around by the cores (cache.pos, block starts, branch locations) are
+	in the executable view, the generated code is stored through
+	cache_rwptr() which translates into the writable view.
+*/
+
+#if (C_HAVE_MEMFD_CREATE)
+#include <unistd.h>
+#endif
+
+/* Define temporary pagesize so the MPROTECT case and the regular case share as much code as possible */
+#if (C_HAVE_MPROTECT)
+#define PAGESIZE_TEMP PAGESIZE
+#else
+#define PAGESIZE_TEMP 4096
+#endif
+
+// distance from the executable to the writable view of the code cache,
+// zero as long as the cache is mapped only once
+static Bitu cache_code_rw_offset=0;
+
+// the location through which pos (executable view) can be written
+static INLINE Bit8u * cache_rwptr(Bit8u * pos) {
+	return (Bit8u*)((Bitu)pos+cache_code_rw_offset);
+}
+
+#if (C_HAVE_MPROTECT) && (C_HAVE_MEMFD_CREATE)
+// map an anonymous memory object of size bytes twice, returns the executable view
+static Bit8u * cache_map_dual(Bitu size) {
+	size=(size+PAGESIZE_TEMP-1) & ~(PAGESIZE_TEMP-1);
+	int fd=memfd_create("dosbox-dyncache",0);
+	if (fd<0) return NULL;
+	Bit8u * rx=NULL;
+	if (!ftruncate(fd,size)) {
+		void * rw_view=mmap(NULL,size,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+		void * rx_view=mmap(NULL,size,PROT_READ|PROT_EXEC,MAP_SHARED,fd,0);
+		if ((rw_view!=MAP_FAILED) && (rx_view!=MAP_FAILED)) {
+			rx=(Bit8u*)rx_view;
+			cache_code_rw_offset=(Bitu)rw_view-(Bitu)rx_view;
+		} else {
+			if (rw_view!=MAP_FAILED) munmap(rw_view,size);
+			if (rx_view!=MAP_FAILED) munmap(rx_view,size);
+		}
+	}
+	// the mappings keep the memory object alive
+	close(fd);
+	return rx;
+}
+#endif
+
+// allocate size bytes of code cache memory, the caller aligns the returned
+// pointer to the next page boundary; dual_mapping is set if every write
+// to the generated code of the core goes through cache_rwptr()
+static Bit8u * cache_alloc_code(Bitu size,bool dual_mapping) {
+	Bit8u * ptr;
+#if defined (WIN32)
+	ptr=(Bit8u*)VirtualAlloc(0,size,MEM_COMMIT,PAGE_EXECUTE_READWRITE);
+	if (ptr) return ptr;
+#endif
+	ptr=(Bit8u*)malloc(size);
+	if (!ptr) return NULL;
+#if (C_HAVE_MPROTECT)
+	Bit8u * aligned=(Bit8u*)(((Bitu)ptr + PAGESIZE_TEMP-1) & ~(PAGESIZE_TEMP-1));
+	if (!mprotect(aligned,size-(PAGESIZE_TEMP-1),PROT_WRITE|PROT_READ|PROT_EXEC)) return ptr;
+#if (C_HAVE_MEMFD_CREATE)
+	if (dual_mapping) {
+		Bit8u * rx=cache_map_dual(size);
+		if (rx) {
+			LOG_MSG("Code cache is not allowed to be writable and executable, using two mappings");
+			free(ptr);
+			return rx;
+		}
+	}
+#endif
+	LOG_MSG("Setting execute permission on the code cache has failed");
+#endif
+	return ptr;
+}
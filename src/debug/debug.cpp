@@ -73,6 +73,10 @@ static void LogCPUInfo(void);
 static void OutputVecTable(char* filename);
 static void DrawVariables(void);
 
+#if (C_DYNREC)
+void CPU_Core_Dynrec_ShowStats(void);
+#endif
+
 char* AnalyzeInstruction(char* inst, bool saveSelector);
 Bit32u GetHexValue(char* str, char*& hex);
 
@@ -1275,6 +1279,10 @@ bool ParseCommand(char* str) {
 
 	if (command == "CPU") {LogCPUInfo(); return true;}
 
+#if (C_DYNREC)
+	if (command == "DYNREC") {CPU_Core_Dynrec_ShowStats(); return true;}
+#endif
+
 	if (command == "INTVEC") {
 		if (found[0] != 0) {
 			OutputVecTable(found);
@@ -1359,6 +1367,9 @@ bool ParseCommand(char* str) {
 		DEBUG_ShowMsg("INTHAND [intNum]          - Set code view to interrupt handler.\n");
 
 		DEBUG_ShowMsg("CPU                       - Display CPU status information.\n");
+#if (C_DYNREC)
+		DEBUG_ShowMsg("DYNREC                    - Display dynamic core cache statistics.\n");
+#endif
 		DEBUG_ShowMsg("GDT                       - Lists descriptors of the GDT.\n");
 		DEBUG_ShowMsg("LDT                       - Lists descriptors of the LDT.\n");
 		DEBUG_ShowMsg("IDT                       - Lists descriptors of the IDT.\n");
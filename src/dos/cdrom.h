@@ -196,6 +196,7 @@ public:
 	bool	ReadSectors		(PhysPt buffer, bool raw, unsigned long sector, unsigned long num);
 	bool	LoadUnloadMedia		(bool unload);
 	bool	ReadSector		(Bit8u *buffer, bool raw, unsigned long sector);
+	bool	ReadSectorsHost		(Bit8u *buffer, bool raw, unsigned long sector, unsigned long num);
 	bool	HasDataTrack		(void);
 	
 static	CDROM_Interface_Image* images[26];
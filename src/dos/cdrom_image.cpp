@@ -269,11 +269,7 @@ bool CDROM_Interface_Image::ReadSectors(PhysPt buffer, bool raw, unsigned long s
 	Bitu buflen = num * sectorSize;
 	Bit8u* buf = new Bit8u[buflen];
 	
-	bool success = true; //Gobliiins reads 0 sectors
-	for(unsigned long i = 0; i < num; i++) {
-		success = ReadSector(&buf[i * sectorSize], raw, sector + i);
-		if (!success) break;
-	}
+	bool success = ReadSectorsHost(buf, raw, sector, num); //Gobliiins reads 0 sectors
 
 	MEM_BlockWrite(buffer, buf, buflen);
 	delete[] buf;
@@ -314,6 +310,45 @@ bool CDROM_Interface_Image::ReadSector(Bit8u *buffer, bool raw, unsigned long se
 	return tracks[track].file->read(buffer, seek, length);
 }
 
+// consecutive sectors of a data track are read from the image file in one go
+bool CDROM_Interface_Image::ReadSectorsHost(Bit8u *buffer, bool raw, unsigned long sector, unsigned long num)
+{
+	int length = (raw ? RAW_SECTOR_SIZE : COOKED_SECTOR_SIZE);
+	while (num) {
+		int track = GetTrack(sector) - 1;
+		if (track < 0) return false;
+		Track &curr = tracks[track];
+		unsigned long run = tracks[track + 1].start - sector;
+		if (run > num) run = num;
+		if (run == 1 || !dynamic_cast<BinaryFile*>(curr.file)) {
+			if (!ReadSector(buffer, raw, sector)) return false;
+			run = 1;
+		} else {
+			if (curr.sectorSize != RAW_SECTOR_SIZE && raw) return false;
+			int seek = curr.skip + (sector - curr.start) * curr.sectorSize;
+			if (curr.sectorSize == length) {
+				if (!curr.file->read(buffer, seek, (int)run * length)) return false;
+			} else {
+				// strip the headers of raw sectors
+				int offset = 0;
+				if (curr.sectorSize == RAW_SECTOR_SIZE && !curr.mode2 && !raw) offset += 16;
+				if (curr.mode2 && !raw) offset += 24;
+				Bit8u* frames = new Bit8u[run * curr.sectorSize];
+				bool success = curr.file->read(frames, seek, (int)run * curr.sectorSize);
+				for (unsigned long i = 0; success && i < run; i++) {
+					memcpy(&buffer[i * length], &frames[i * curr.sectorSize + offset], length);
+				}
+				delete[] frames;
+				if (!success) return false;
+			}
+		}
+		buffer += run * length;
+		sector += run;
+		num -= run;
+	}
+	return true;
+}
+
 void CDROM_Interface_Image::CDAudioCallBack(Bitu len)
 {
 	len *= 4;       // 16 bit, stereo
@@ -154,6 +154,21 @@ public:
 			WriteOut(UnmountHelper(umount[0]), toupper(umount[0]));
 			return;
 		}
+
+		/* Write a compressed copy of an image, usable as base of an overlay */
+		std::string compressed;
+		if (cmd->FindString("-compress",compressed,true)) {
+			if (!cmd->FindCommand(1,temp_line)) {
+				WriteOut(MSG_Get("PROGRAM_IMGMOUNT_SPECIFY_FILE"));
+				return;
+			}
+			Cross::ResolveHomedir(temp_line);
+			Cross::ResolveHomedir(compressed);
+			if (imageOverlay::Compress(temp_line.c_str(),compressed.c_str()))
+				WriteOut(MSG_Get("PROGRAM_IMGMOUNT_COMPRESSED"),compressed.c_str());
+			else WriteOut(MSG_Get("PROGRAM_IMGMOUNT_CANT_COMPRESS"),temp_line.c_str());
+			return;
+		}
 		
 		/* Check for moving Z: */
 		/* Only allowing moving it once. It is merely a convenience added for the wine team */
@@ -564,9 +579,8 @@ private:
 			}
 
 			// get file size
-			fseek(tmpfile,0L, SEEK_END);
-			*ksize = (ftell(tmpfile) / 1024);
-			*bsize = ftell(tmpfile);
+			*bsize = imageOverlay::GetImageSize(tmpfile);
+			*ksize = (*bsize / 1024);
 			fclose(tmpfile);
 
 			tmpfile = ldp->GetSystemFilePtr(fullname, "rb+");
@@ -602,9 +616,8 @@ private:
 //				fclose(tmpfile);
 //				if(tryload) error = 2;
 				WriteOut(MSG_Get("PROGRAM_BOOT_WRITE_PROTECTED"));
-				fseek(tmpfile,0L, SEEK_END);
-				*ksize = (ftell(tmpfile) / 1024);
-				*bsize = ftell(tmpfile);
+				*bsize = imageOverlay::GetImageSize(tmpfile);
+				*ksize = (*bsize / 1024);
 				return tmpfile;
 			}
 			// Give the delayed errormessages from the mounted variant (or from above)
@@ -612,9 +625,8 @@ private:
 			if(error == 2) WriteOut(MSG_Get("PROGRAM_BOOT_NOT_OPEN"));
 			return NULL;
 		}
-		fseek(tmpfile,0L, SEEK_END);
-		*ksize = (ftell(tmpfile) / 1024);
-		*bsize = ftell(tmpfile);
+		*bsize = imageOverlay::GetImageSize(tmpfile);
+		*ksize = (*bsize / 1024);
 		return tmpfile;
 	}
 
@@ -725,6 +737,12 @@ public:
 			return;
 		}
 
+		/* The booted system takes over the disks, write out the FATs mounted drives keep in memory */
+		for (Bitu d=0;d<DOS_DRIVES;d++) {
+			fatDrive * fdrive=dynamic_cast<fatDrive*>(Drives[d]);
+			if (fdrive) fdrive->flushFAT();
+		}
+
 		bootSector bootarea;
 		imageDiskList[drive-65]->Read_Sector(0,0,1,(Bit8u *)&bootarea);
 		if ((bootarea.rawdata[0]==0x50) && (bootarea.rawdata[1]==0x43) && (bootarea.rawdata[2]==0x6a) && (bootarea.rawdata[3]==0x72)) {
@@ -1170,6 +1188,8 @@ public:
 		std::string fstype="fat";
 		cmd->FindString("-t",type,true);
 		cmd->FindString("-fs",fstype,true);
+		std::string overlay;
+		cmd->FindString("-overlay",overlay,true);
 		if(type == "cdrom") type = "iso"; //Tiny hack for people who like to type -t cdrom
 		Bit8u mediaid;
 		if (type=="floppy" || type=="hdd" || type=="iso") {
@@ -1277,6 +1297,20 @@ public:
 				WriteOut(MSG_Get("PROGRAM_IMGMOUNT_SPECIFY_FILE"));
 				return;	
 			}
+			if (overlay.size()) {
+				/* writes go to the overlay, the image itself stays unmodified */
+				if (paths.size() != 1 || fstype=="iso") {
+					WriteOut(MSG_Get("PROGRAM_IMGMOUNT_OVERLAY_SINGLE"));
+					return;
+				}
+				Cross::ResolveHomedir(overlay);
+				struct stat test;
+				if (stat(overlay.c_str(),&test) && !imageOverlay::Create(overlay.c_str(),paths[0].c_str())) {
+					WriteOut(MSG_Get("PROGRAM_IMGMOUNT_CANT_CREATE_OVERLAY"),overlay.c_str());
+					return;
+				}
+				paths[0] = overlay;
+			}
 			if (paths.size() == 1)
 				temp_line = paths[0];
 
@@ -1287,16 +1321,21 @@ public:
 						WriteOut(MSG_Get("PROGRAM_IMGMOUNT_INVALID_IMAGE"));
 						return;
 					}
-					fseek(diskfile, 0L, SEEK_END);
-					Bit32u fcsize = (Bit32u)(ftell(diskfile) / 512L);
+					Bit32u fcsize = imageOverlay::GetImageSize(diskfile) / 512L;
 					Bit8u buf[512];
-					fseek(diskfile, 0L, SEEK_SET);
-					if (fread(buf,sizeof(Bit8u),512,diskfile)<512) {
-						fclose(diskfile);
+					imageOverlay * layers = imageOverlay::Open(diskfile, temp_line.c_str());
+					if (layers) {
+						layers->Read(0, buf, 512);
+						delete layers;
+					} else {
+						fseek(diskfile, 0L, SEEK_SET);
+						if (fread(buf,sizeof(Bit8u),512,diskfile)<512) fcsize = 0;
+					}
+					fclose(diskfile);
+					if (fcsize == 0) {
 						WriteOut(MSG_Get("PROGRAM_IMGMOUNT_INVALID_IMAGE"));
 						return;
 					}
-					fclose(diskfile);
 					if ((buf[510]!=0x55) || (buf[511]!=0xaa)) {
 						WriteOut(MSG_Get("PROGRAM_IMGMOUNT_INVALID_GEOMETRY"));
 						return;
@@ -1434,8 +1473,7 @@ public:
 					WriteOut(MSG_Get("PROGRAM_IMGMOUNT_INVALID_IMAGE"));
 					return;
 				}
-				fseek(newDisk,0L, SEEK_END);
-				imagesize = (ftell(newDisk) / 1024);
+				imagesize = imageOverlay::GetImageSize(newDisk) / 1024;
 
 				newImage = new imageDisk(newDisk, (Bit8u *)temp_line.c_str(), imagesize, (imagesize > 2880));
 				if(imagesize>2880) newImage->Set_Geometry(sizes[2],sizes[3],sizes[1],sizes[0]);
@@ -1710,7 +1748,13 @@ void DOS_SetupPrograms(void) {
 		"\n"
 		"For \033[33mhardrive\033[0m images: Must specify drive geometry for hard drives:\n"
 		"bytes_per_sector, sectors_per_cylinder, heads_per_cylinder, cylinder_count.\n"
-		"\033[34;1mIMGMOUNT drive-letter location-of-image -size bps,spc,hpc,cyl\033[0m\n");
+		"\033[34;1mIMGMOUNT drive-letter location-of-image -size bps,spc,hpc,cyl\033[0m\n"
+		"\n"
+		"To keep an image unmodified and write the changes to an overlay file:\n"
+		"\033[34;1mIMGMOUNT drive-letter location-of-image -overlay location-of-overlay\033[0m\n"
+		"An existing overlay file is used again, it can also be mounted or booted directly.\n"
+		"To create a compressed read-only image, usable as base of an overlay:\n"
+		"\033[34;1mIMGMOUNT location-of-image -compress location-of-compressed-image\033[0m\n");
 	MSG_Add("PROGRAM_IMGMOUNT_INVALID_IMAGE","Could not load image file.\n"
 		"Check that the path is correct and the image is accessible.\n");
 	MSG_Add("PROGRAM_IMGMOUNT_INVALID_GEOMETRY","Could not extract drive geometry from image.\n"
@@ -1725,6 +1769,10 @@ void DOS_SetupPrograms(void) {
 	MSG_Add("PROGRAM_IMGMOUNT_MOUNT_NUMBER","Drive number %d mounted as %s\n");
 	MSG_Add("PROGRAM_IMGMOUNT_NON_LOCAL_DRIVE", "The image must be on a host or local drive.\n");
 	MSG_Add("PROGRAM_IMGMOUNT_MULTIPLE_NON_CUEISO_FILES", "Using multiple files is only supported for cue/iso images.\n");
+	MSG_Add("PROGRAM_IMGMOUNT_OVERLAY_SINGLE","An overlay can only be used with a single hard disk or floppy image.\n");
+	MSG_Add("PROGRAM_IMGMOUNT_CANT_CREATE_OVERLAY","Could not create the overlay file %s.\n");
+	MSG_Add("PROGRAM_IMGMOUNT_COMPRESSED","Compressed image %s written.\n");
+	MSG_Add("PROGRAM_IMGMOUNT_CANT_COMPRESS","Could not compress image %s.\n");
 
 	MSG_Add("PROGRAM_KEYB_INFO","Codepage %i has been loaded\n");
 	MSG_Add("PROGRAM_KEYB_INFO_LAYOUT","Codepage %i has been loaded for layout %s\n");
@@ -59,6 +59,7 @@ public:
 
 	bool loadedSector;
 	fatDrive *myDrive;
+	fatExtentMap extents;
 private:
 	enum { NONE,READ,WRITE } last_action;
 	Bit16u info;
@@ -111,7 +112,7 @@ bool fatFile::Read(Bit8u * data, Bit16u *size) {
 	}
 
 	if (!loadedSector) {
-		currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+		currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &extents);
 		if(currentSector == 0) {
 			/* EOC reached before EOF */
 			*size = 0;
@@ -133,7 +134,7 @@ bool fatFile::Read(Bit8u * data, Bit16u *size) {
 		data[sizecount++] = sectorBuffer[curSectOff++];
 		seekpos++;
 		if(curSectOff >= myDrive->getSectorSize()) {
-			currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+			currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &extents);
 			if(currentSector == 0) {
 				/* EOC reached before EOF */
 				//LOG_MSG("EOC reached before EOF, seekpos %d, filelen %d", seekpos, filelength);
@@ -195,17 +196,17 @@ bool fatFile::Write(Bit8u * data, Bit16u *size) {
 				firstCluster = myDrive->getFirstFreeClust();
 				if(firstCluster == 0) goto finalizeWrite; // out of space
 				myDrive->allocateCluster(firstCluster, 0);
-				currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+				currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &extents);
 				myDrive->readSector(currentSector, sectorBuffer);
 				loadedSector = true;
 			}
 			if (!loadedSector) {
-				currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+				currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &extents);
 				if(currentSector == 0) {
 					/* EOC reached before EOF - try to increase file allocation */
 					myDrive->appendCluster(firstCluster);
 					/* Try getting sector again */
-					currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+					currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &extents);
 					if(currentSector == 0) {
 						/* No can do. lets give up and go home.  We must be out of room */
 						goto finalizeWrite;
@@ -222,12 +223,12 @@ bool fatFile::Write(Bit8u * data, Bit16u *size) {
 		if(curSectOff >= myDrive->getSectorSize()) {
 			if(loadedSector) myDrive->writeSector(currentSector, sectorBuffer);
 
-			currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+			currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &extents);
 			if(currentSector == 0) {
 				/* EOC reached before EOF - try to increase file allocation */
 				myDrive->appendCluster(firstCluster);
 				/* Try getting sector again */
-				currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+				currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &extents);
 				if(currentSector == 0) {
 					/* No can do. lets give up and go home.  We must be out of room */
 					loadedSector = false;
@@ -271,7 +272,7 @@ bool fatFile::Seek(Bit32u *pos, Bit32u type) {
 
 	if(seekto<0) seekto = 0;
 	seekpos = (Bit32u)seekto;
-	currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos);
+	currentSector = myDrive->getAbsoluteSectFromBytePos(firstCluster, seekpos, &extents);
 	if (currentSector == 0) {
 		/* not within file size, thus no sector is available */
 		loadedSector = false;
@@ -287,6 +288,7 @@ bool fatFile::Seek(Bit32u *pos, Bit32u type) {
 bool fatFile::Close() {
 	/* Flush buffer */
 	if (loadedSector) myDrive->writeSector(currentSector, sectorBuffer);
+	myDrive->flushFAT();
 
 	return false;
 }
@@ -303,37 +305,40 @@ Bit32u fatDrive::getClustFirstSect(Bit32u clustNum) {
 	return ((clustNum - 2) * bootbuffer.sectorspercluster) + firstDataSector;
 }
 
+/* The FAT was written through INT 13, the copy in memory is dropped */
+void fatDrive::checkFAT(void) {
+	if(GCC_LIKELY(!loadedDisk->table_stale)) return;
+	loadedDisk->table_stale = false;
+	loadFAT();
+	chainGeneration++;
+}
+
 Bit32u fatDrive::getClusterValue(Bit32u clustNum) {
+	checkFAT();
 	Bit32u fatoffset=0;
-	Bit32u fatsectnum;
-	Bit32u fatentoff;
+	Bit32u fatentsize=0;
 	Bit32u clustValue=0;
 
 	switch(fattype) {
 		case FAT12:
 			fatoffset = clustNum + (clustNum / 2);
+			fatentsize = 2;
 			break;
 		case FAT16:
 			fatoffset = clustNum * 2;
+			fatentsize = 2;
 			break;
 		case FAT32:
 			fatoffset = clustNum * 4;
+			fatentsize = 4;
 			break;
 	}
-	fatsectnum = bootbuffer.reservedsectors + (fatoffset / bootbuffer.bytespersector) + partSectOff;
-	fatentoff = fatoffset % bootbuffer.bytespersector;
-
-	if(curFatSect != fatsectnum) {
-		/* Load two sectors at once for FAT12 */
-		readSector(fatsectnum, &fatSectBuffer[0]);
-		if (fattype==FAT12)
-			readSector(fatsectnum+1, &fatSectBuffer[512]);
-		curFatSect = fatsectnum;
-	}
+	/* Broken chains may point anywhere, the whole entry has to be inside the FAT */
+	if((Bit64u)fatoffset + fatentsize > fatTable.size() - 2) return 0;
 
 	switch(fattype) {
 		case FAT12:
-			clustValue = *((Bit16u *)&fatSectBuffer[fatentoff]);
+			clustValue = *((Bit16u *)&fatTable[fatoffset]);
 			if(clustNum & 0x1) {
 				clustValue >>= 4;
 			} else {
@@ -341,10 +346,10 @@ Bit32u fatDrive::getClusterValue(Bit32u clustNum) {
 			}
 			break;
 		case FAT16:
-			clustValue = *((Bit16u *)&fatSectBuffer[fatentoff]);
+			clustValue = *((Bit16u *)&fatTable[fatoffset]);
 			break;
 		case FAT32:
-			clustValue = *((Bit32u *)&fatSectBuffer[fatentoff]);
+			clustValue = *((Bit32u *)&fatTable[fatoffset]);
 			break;
 	}
 
@@ -352,35 +357,41 @@ Bit32u fatDrive::getClusterValue(Bit32u clustNum) {
 }
 
 void fatDrive::setClusterValue(Bit32u clustNum, Bit32u clustValue) {
+	checkFAT();
 	Bit32u fatoffset=0;
-	Bit32u fatsectnum;
-	Bit32u fatentoff;
+	Bit32u fatentsize=0;
 
 	switch(fattype) {
 		case FAT12:
 			fatoffset = clustNum + (clustNum / 2);
+			fatentsize = 2;
 			break;
 		case FAT16:
 			fatoffset = clustNum * 2;
+			fatentsize = 2;
 			break;
 		case FAT32:
 			fatoffset = clustNum * 4;
+			fatentsize = 4;
 			break;
 	}
-	fatsectnum = bootbuffer.reservedsectors + (fatoffset / bootbuffer.bytespersector) + partSectOff;
-	fatentoff = fatoffset % bootbuffer.bytespersector;
-
-	if(curFatSect != fatsectnum) {
-		/* Load two sectors at once for FAT12 */
-		readSector(fatsectnum, &fatSectBuffer[0]);
-		if (fattype==FAT12)
-			readSector(fatsectnum+1, &fatSectBuffer[512]);
-		curFatSect = fatsectnum;
+	if((Bit64u)fatoffset + fatentsize > fatTable.size() - 2) return;
+
+	if(clustNum >= 2 && clustNum < CountOfClusters + 2) {
+		bool wasFree = freeClusters[clustNum - 2];
+		if(wasFree && clustValue != 0) {
+			freeClusters[clustNum - 2] = false;
+			freeCount--;
+			nextFreeHint = clustNum + 1;
+		} else if(!wasFree && clustValue == 0) {
+			freeClusters[clustNum - 2] = true;
+			freeCount++;
+		}
 	}
 
 	switch(fattype) {
 		case FAT12: {
-			Bit16u tmpValue = *((Bit16u *)&fatSectBuffer[fatentoff]);
+			Bit16u tmpValue = *((Bit16u *)&fatTable[fatoffset]);
 			if(clustNum & 0x1) {
 				clustValue &= 0xfff;
 				clustValue <<= 4;
@@ -392,23 +403,55 @@ void fatDrive::setClusterValue(Bit32u clustNum, Bit32u clustValue) {
 				tmpValue &= 0xf000;
 				tmpValue |= (Bit16u)clustValue;
 			}
-			*((Bit16u *)&fatSectBuffer[fatentoff]) = tmpValue;
+			*((Bit16u *)&fatTable[fatoffset]) = tmpValue;
 			break;
 			}
 		case FAT16:
-			*((Bit16u *)&fatSectBuffer[fatentoff]) = (Bit16u)clustValue;
+			*((Bit16u *)&fatTable[fatoffset]) = (Bit16u)clustValue;
 			break;
 		case FAT32:
-			*((Bit32u *)&fatSectBuffer[fatentoff]) = clustValue;
+			*((Bit32u *)&fatTable[fatoffset]) = clustValue;
 			break;
 	}
-	for(int fc=0;fc<bootbuffer.fatcopies;fc++) {
-		writeSector(fatsectnum + (fc * bootbuffer.sectorsperfat), &fatSectBuffer[0]);
-		if (fattype==FAT12) {
-			if (fatentoff>=511)
-				writeSector(fatsectnum+1+(fc * bootbuffer.sectorsperfat), &fatSectBuffer[512]);
+	/* FAT12 entries can straddle two sectors */
+	fatSectDirty[fatoffset / bootbuffer.bytespersector] = true;
+	fatSectDirty[(fatoffset + fatentsize - 1) / bootbuffer.bytespersector] = true;
+	fatDirty = true;
+}
+
+void fatDrive::loadFAT(void) {
+	Bit32u bps = bootbuffer.bytespersector;
+	/* Padding to read the last entry as a word */
+	fatTable.assign(bootbuffer.sectorsperfat * bps + 2, 0);
+	fatSectDirty.assign(bootbuffer.sectorsperfat + 1, false);
+	fatDirty = false;
+	for(Bit32u i=0;i<bootbuffer.sectorsperfat;i++) {
+		readSector(bootbuffer.reservedsectors + partSectOff + i, &fatTable[i * bps]);
+	}
+
+	freeClusters.assign(CountOfClusters, false);
+	freeCount = 0;
+	for(Bit32u i=0;i<CountOfClusters;i++) {
+		if(!getClusterValue(i+2)) {
+			freeClusters[i] = true;
+			freeCount++;
+		}
+	}
+	nextFreeHint = 2;
+}
+
+void fatDrive::flushFAT(void) {
+	checkFAT();
+	if(!fatDirty) return;
+	Bit32u bps = bootbuffer.bytespersector;
+	for(Bit32u i=0;i<bootbuffer.sectorsperfat;i++) {
+		if(!fatSectDirty[i]) continue;
+		for(int fc=0;fc<bootbuffer.fatcopies;fc++) {
+			writeSector(bootbuffer.reservedsectors + partSectOff + i + (fc * bootbuffer.sectorsperfat), &fatTable[i * bps]);
 		}
+		fatSectDirty[i] = false;
 	}
+	fatDirty = false;
 }
 
 bool fatDrive::getEntryName(char *fullname, char *entname) {
@@ -543,17 +586,41 @@ Bit32u fatDrive::getClusterSize(void) {
 	return bootbuffer.sectorspercluster * bootbuffer.bytespersector;
 }
 
-Bit32u fatDrive::getAbsoluteSectFromBytePos(Bit32u startClustNum, Bit32u bytePos) {
-	return  getAbsoluteSectFromChain(startClustNum, bytePos / bootbuffer.bytespersector);
+Bit32u fatDrive::getAbsoluteSectFromBytePos(Bit32u startClustNum, Bit32u bytePos, fatExtentMap * extents) {
+	return  getAbsoluteSectFromChain(startClustNum, bytePos / bootbuffer.bytespersector, extents);
 }
 
-Bit32u fatDrive::getAbsoluteSectFromChain(Bit32u startClustNum, Bit32u logicalSector) {
+Bit32u fatDrive::getAbsoluteSectFromChain(Bit32u startClustNum, Bit32u logicalSector, fatExtentMap * extents) {
 	Bit32s skipClust = logicalSector / bootbuffer.sectorspercluster;
 	Bit32u sectClust = logicalSector % bootbuffer.sectorspercluster;
 
 	Bit32u currentClust = startClustNum;
 	Bit32u testvalue;
 
+	if(extents) {
+		std::vector<fatClusterRun> & runs = extents->runs;
+		if(extents->startCluster != startClustNum || extents->generation != chainGeneration || runs.empty()) {
+			fatClusterRun first = { 0, startClustNum, 1 };
+			runs.clear();
+			runs.push_back(first);
+			extents->startCluster = startClustNum;
+			extents->generation = chainGeneration;
+		}
+		/* Find the last run that starts at or before the wanted cluster */
+		Bitu lo = 0, hi = runs.size();
+		while(hi - lo > 1) {
+			Bitu mid = (lo + hi) / 2;
+			if(runs[mid].index <= (Bit32u)skipClust) lo = mid; else hi = mid;
+		}
+		if((Bit32u)skipClust < runs[lo].index + runs[lo].count) {
+			return (getClustFirstSect(runs[lo].cluster + (skipClust - runs[lo].index)) + sectClust);
+		}
+		/* Beyond the known part, continue the walk at its last cluster */
+		fatClusterRun & last = runs.back();
+		currentClust = last.cluster + last.count - 1;
+		skipClust -= last.index + last.count - 1;
+	}
+
 	while(skipClust!=0) {
 		bool isEOF = false;
 		testvalue = getClusterValue(currentClust);
@@ -576,6 +643,15 @@ Bit32u fatDrive::getAbsoluteSectFromChain(Bit32u startClustNum, Bit32u logicalSe
 			}
 			return 0;
 		}
+		if(extents) {
+			fatClusterRun & last = extents->runs.back();
+			if(testvalue == last.cluster + last.count) {
+				last.count++;
+			} else {
+				fatClusterRun run = { last.index + last.count, testvalue, 1 };
+				extents->runs.push_back(run);
+			}
+		}
 		currentClust = testvalue;
 		--skipClust;
 	}
@@ -584,6 +660,7 @@ Bit32u fatDrive::getAbsoluteSectFromChain(Bit32u startClustNum, Bit32u logicalSe
 }
 
 void fatDrive::deleteClustChain(Bit32u startCluster, Bit32u bytePos) {
+	chainGeneration++;
 	Bit32u clustSize = getClusterSize();
 	Bit32u endClust = (bytePos + clustSize - 1) / clustSize;
 	Bit32u countClust = 1;
@@ -629,6 +706,9 @@ void fatDrive::deleteClustChain(Bit32u startCluster, Bit32u bytePos) {
 		currentClust = testvalue;
 		countClust++;
 	}
+	/* The directory entry was written already, the image must not be
+	   left with clusters that are freed in memory only */
+	flushFAT();
 }
 
 Bit32u fatDrive::appendCluster(Bit32u startCluster) {
@@ -707,8 +787,8 @@ fatDrive::fatDrive(const char *sysFilename, Bit32u bytesector, Bit32u cylsector,
 
 	diskfile = fopen(sysFilename, "rb+");
 	if(!diskfile) {created_successfully = false;return;}
-	fseek(diskfile, 0L, SEEK_END);
-	filesize = (Bit32u)ftell(diskfile) / 1024L;
+	filesize = imageOverlay::GetImageSize(diskfile) / 1024L;
+	if(!filesize) {fclose(diskfile);created_successfully = false;return;}
 	is_hdd = (filesize > 2880);
 
 	/* Load disk image */
@@ -861,8 +941,11 @@ fatDrive::fatDrive(const char *sysFilename, Bit32u bytesector, Bit32u cylsector,
 	/* There is no cluster 0, this means we are in the root directory */
 	cwdDirCluster = 0;
 
-	memset(fatSectBuffer,0,1024);
-	curFatSect = 0xffffffff;
+	loadFAT();
+	chainGeneration = 0;
+	loadedDisk->table_start = bootbuffer.reservedsectors + partSectOff;
+	loadedDisk->table_end = loadedDisk->table_start + bootbuffer.sectorsperfat * bootbuffer.fatcopies;
+	loadedDisk->table_stale = false;
 
 	strcpy(info, "fatDrive ");
 	strcat(info, sysFilename);
@@ -881,7 +964,8 @@ bool fatDrive::AllocationInfo(Bit16u *_bytes_sector, Bit8u *_sectors_cluster, Bi
 		// maybe some special handling needed for fat32
 		*_total_clusters = 65535;
 	}
-	for(i=0;i<CountOfClusters;i++) if(!getClusterValue(i+2)) countFree++;
+	checkFAT();
+	countFree = freeCount;
 	if (countFree<65536) *_free_clusters = (Bit16u)countFree;
 	else {
 		// maybe some special handling needed for fat32
@@ -891,10 +975,17 @@ bool fatDrive::AllocationInfo(Bit16u *_bytes_sector, Bit8u *_sectors_cluster, Bi
 	return true;
 }
 
+/* Next fit, the search continues after the last allocated cluster */
 Bit32u fatDrive::getFirstFreeClust(void) {
+	checkFAT();
+	if(freeCount == 0) return 0;
 	Bit32u i;
-	for(i=0;i<CountOfClusters;i++) {
-		if(!getClusterValue(i+2)) return (i+2);
+	Bit32u start = (nextFreeHint >= 2 && nextFreeHint < CountOfClusters + 2) ? nextFreeHint - 2 : 0;
+	for(i=start;i<CountOfClusters;i++) {
+		if(freeClusters[i]) return (i+2);
+	}
+	for(i=0;i<start;i++) {
+		if(freeClusters[i]) return (i+2);
 	}
 
 	/* No free cluster found */
@@ -909,6 +1000,13 @@ Bits fatDrive::UnMount(void) {
 	return 0;
 }
 
+fatDrive::~fatDrive() {
+	if(created_successfully) {
+		flushFAT();
+		loadedDisk->Flush();
+	}
+}
+
 Bit8u fatDrive::GetMediaByte(void) { return loadedDisk->GetBiosType(); }
 
 bool fatDrive::FileCreate(DOS_File **file, char *name, Bit16u attributes) {
@@ -1224,6 +1322,7 @@ bool fatDrive::directoryChange(Bit32u dirClustNumber, direntry *useEntry, Bit32s
 	}
 	if(tmpsector != 0) {
         memcpy(&sectbuf[entryoffset], useEntry, sizeof(direntry));
+		flushFAT();
 		writeSector(tmpsector, sectbuf);
         return true;
 	} else {
@@ -1265,6 +1364,7 @@ bool fatDrive::addDirectoryEntry(Bit32u dirClustNumber, direntry useEntry) {
 		/* Deleted file entry or end of directory list */
 		if ((sectbuf[entryoffset].entryname[0] == 0xe5) || (sectbuf[entryoffset].entryname[0] == 0x00)) {
 			sectbuf[entryoffset] = useEntry;
+			flushFAT();
 			writeSector(tmpsector,sectbuf);
 			break;
 		}
@@ -40,8 +40,6 @@ public:
 	Bit16u GetInformation(void);
 private:
 	isoDrive *drive;
-	Bit8u buffer[ISO_FRAMESIZE];
-	int cachedSector;
 	Bit32u fileBegin;
 	Bit32u filePos;
 	Bit32u fileEnd;
@@ -56,7 +54,6 @@ isoFile::isoFile(isoDrive *drive, const char *name, FileStat_Block *stat, Bit32u
 	fileBegin = offset;
 	filePos = fileBegin;
 	fileEnd = fileBegin + stat->size;
-	cachedSector = -1;
 	open = true;
 	this->name = NULL;
 	SetName(name);
@@ -67,35 +64,30 @@ bool isoFile::Read(Bit8u *data, Bit16u *size) {
 		*size = (Bit16u)(fileEnd - filePos);
 	
 	Bit16u nowSize = 0;
-	int sector = filePos / ISO_FRAMESIZE;
-	Bit16u sectorPos = (Bit16u)(filePos % ISO_FRAMESIZE);
-	
-	if (sector != cachedSector) {
-		if (drive->readSector(buffer, sector)) cachedSector = sector;
-		else { *size = 0; cachedSector = -1; }
-	}
 	while (nowSize < *size) {
-		Bit16u remSector = ISO_FRAMESIZE - sectorPos;
+		Bit32u sector = filePos / ISO_FRAMESIZE;
+		Bit16u sectorPos = (Bit16u)(filePos % ISO_FRAMESIZE);
 		Bit16u remSize = *size - nowSize;
-		if(remSector < remSize) {
-			memcpy(&data[nowSize], &buffer[sectorPos], remSector);
-			nowSize += remSector;
-			sectorPos = 0;
-			sector++;
-			cachedSector++;
-			if (!drive->readSector(buffer, sector)) {
-				*size = nowSize;
-				cachedSector = -1;
+		if (sectorPos == 0 && remSize >= ISO_FRAMESIZE) {
+			// whole sectors are read straight into the callers buffer
+			Bit32u count = remSize / ISO_FRAMESIZE;
+			if (drive->readSectors(&data[nowSize], sector, count)) {
+				nowSize += (Bit16u)(count * ISO_FRAMESIZE);
+				filePos += count * ISO_FRAMESIZE;
+				continue;
 			}
-		} else {
-			memcpy(&data[nowSize], &buffer[sectorPos], remSize);
-			nowSize += remSize;
+			// fall back to single sectors to get as far as possible
 		}
-			
+		Bit8u *buffer;
+		if (!drive->readFileSector(&buffer, sector)) break;
+		Bit16u remSector = ISO_FRAMESIZE - sectorPos;
+		if (remSector > remSize) remSector = remSize;
+		memcpy(&data[nowSize], &buffer[sectorPos], remSector);
+		nowSize += remSector;
+		filePos += remSector;
 	}
 	
 	*size = nowSize;
-	filePos += *size;
 	return true;
 }
 
@@ -143,6 +135,10 @@ isoDrive::isoDrive(char driveLetter, const char *fileName, Bit8u mediaid, int &e
 	nextFreeDirIterator = 0;
 	memset(dirIterators, 0, sizeof(dirIterators));
 	memset(sectorHashEntries, 0, sizeof(sectorHashEntries));
+	for (Bitu i = 0; i < ISO_CACHE_BLOCKS; i++) sectorCache[i].valid = 0;
+	sectorCacheLru = 0;
+	sectorCacheLast = 0;
+	lastFileBlock = 0xffffffff;
 	memset(&rootEntry, 0, sizeof(isoDirEntry));
 	
 	safe_strncpy(this->fileName, fileName, CROSS_LEN);
@@ -461,6 +457,63 @@ inline bool isoDrive :: readSector(Bit8u *buffer, Bit32u sector) {
 	return CDROM_Interface_Image::images[subUnit]->ReadSector(buffer, false, sector);
 }
 
+bool isoDrive :: readSectors(Bit8u *buffer, Bit32u sector, Bit32u num) {
+	lastFileBlock = (sector + num - 1) / ISO_CACHE_BLOCK_SECTORS;
+	return CDROM_Interface_Image::images[subUnit]->ReadSectorsHost(buffer, false, sector, num);
+}
+
+Bitu isoDrive :: findCacheBlock(Bit32u block) {
+	if (sectorCache[sectorCacheLast].valid && sectorCache[sectorCacheLast].block == block) return sectorCacheLast;
+	for (Bitu i = 0; i < ISO_CACHE_BLOCKS; i++) {
+		if (sectorCache[i].valid && sectorCache[i].block == block) return i;
+	}
+	return ISO_CACHE_BLOCKS;
+}
+
+// read a block of sectors into the least recently used cache entry
+Bitu isoDrive :: loadCacheBlock(Bit32u block) {
+	Bitu index = 0;
+	for (Bitu i = 0; i < ISO_CACHE_BLOCKS; i++) {
+		if (!sectorCache[i].valid) {
+			index = i;
+			break;
+		}
+		if (sectorCache[i].lru < sectorCache[index].lru) index = i;
+	}
+	SectorCacheBlock& cb = sectorCache[index];
+	Bit32u first = block * ISO_CACHE_BLOCK_SECTORS;
+	cb.block = block;
+	cb.lru = ++sectorCacheLru;
+	cb.valid = ISO_CACHE_BLOCK_SECTORS;
+	if (!CDROM_Interface_Image::images[subUnit]->ReadSectorsHost(cb.data, false, first, ISO_CACHE_BLOCK_SECTORS)) {
+		// the block runs past the end of the data, keep what can be read
+		for (cb.valid = 0; cb.valid < ISO_CACHE_BLOCK_SECTORS; cb.valid++) {
+			if (!readSector(&cb.data[cb.valid * ISO_FRAMESIZE], first + cb.valid)) break;
+		}
+		if (!cb.valid) return ISO_CACHE_BLOCKS;
+	}
+	return index;
+}
+
+bool isoDrive :: readFileSector(Bit8u **buffer, Bit32u sector) {
+	Bit32u block = sector / ISO_CACHE_BLOCK_SECTORS;
+	Bitu index = findCacheBlock(block);
+	if (index == ISO_CACHE_BLOCKS) {
+		index = loadCacheBlock(block);
+		if (index == ISO_CACHE_BLOCKS) return false;
+		// sequential access, read the following block ahead
+		if (block == lastFileBlock + 1 && findCacheBlock(block + 1) == ISO_CACHE_BLOCKS) loadCacheBlock(block + 1);
+	}
+	SectorCacheBlock& cb = sectorCache[index];
+	Bit32u offset = sector % ISO_CACHE_BLOCK_SECTORS;
+	if (offset >= cb.valid) return false;
+	cb.lru = ++sectorCacheLru;
+	sectorCacheLast = index;
+	lastFileBlock = block;
+	*buffer = &cb.data[offset * ISO_FRAMESIZE];
+	return true;
+}
+
 int isoDrive :: readDirEntry(isoDirEntry *de, Bit8u *data) {	
 	// copy data into isoDirEntry struct, data[0] = length of DirEntry
 //	if (data[0] > sizeof(isoDirEntry)) return -1;//check disabled as isoDirentry is currently 258 bytes large. So it always fits
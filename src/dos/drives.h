@@ -149,9 +149,26 @@ struct partTable {
 #endif
 //Forward
 class imageDisk;
+/* The part of a cluster chain that has been walked already, as runs of
+   consecutive clusters. Kept by open files so sequential access doesn't
+   follow the chain from its start for every sector. */
+struct fatClusterRun {
+	Bit32u index;		/* position of the first cluster in the chain */
+	Bit32u cluster;
+	Bit32u count;
+};
+
+struct fatExtentMap {
+	fatExtentMap() : startCluster(0), generation(0) { }
+	Bit32u startCluster;
+	Bit32u generation;	/* of fatDrive::chainGeneration when built */
+	std::vector<fatClusterRun> runs;
+};
+
 class fatDrive : public DOS_Drive {
 public:
 	fatDrive(const char * sysFilename, Bit32u bytesector, Bit32u cylsector, Bit32u headscyl, Bit32u cylinders, Bit32u startSector);
+	virtual ~fatDrive();
 	virtual bool FileOpen(DOS_File * * file,char * name,Bit32u flags);
 	virtual bool FileCreate(DOS_File * * file,char * name,Bit16u attributes);
 	virtual bool FileUnlink(char * name);
@@ -172,14 +189,15 @@ public:
 public:
 	Bit8u readSector(Bit32u sectnum, void * data);
 	Bit8u writeSector(Bit32u sectnum, void * data);
-	Bit32u getAbsoluteSectFromBytePos(Bit32u startClustNum, Bit32u bytePos);
+	Bit32u getAbsoluteSectFromBytePos(Bit32u startClustNum, Bit32u bytePos, fatExtentMap * extents=NULL);
 	Bit32u getSectorSize(void);
 	Bit32u getClusterSize(void);
-	Bit32u getAbsoluteSectFromChain(Bit32u startClustNum, Bit32u logicalSector);
+	Bit32u getAbsoluteSectFromChain(Bit32u startClustNum, Bit32u logicalSector, fatExtentMap * extents=NULL);
 	bool allocateCluster(Bit32u useCluster, Bit32u prevCluster);
 	Bit32u appendCluster(Bit32u startCluster);
 	void deleteClustChain(Bit32u startCluster, Bit32u bytePos);
 	Bit32u getFirstFreeClust(void);
+	void flushFAT(void);
 	bool directoryBrowse(Bit32u dirClustNumber, direntry *useEntry, Bit32s entNum, Bit32s start=0);
 	bool directoryChange(Bit32u dirClustNumber, direntry *useEntry, Bit32s entNum);
 	imageDisk *loadedDisk;
@@ -193,6 +211,8 @@ private:
 	bool getFileDirEntry(char const * const filename, direntry * useEntry, Bit32u * dirClust, Bit32u * subEntry);
 	bool addDirectoryEntry(Bit32u dirClustNumber, direntry useEntry);
 	void zeroOutCluster(Bit32u clustNumber);
+	void loadFAT(void);
+	void checkFAT(void);
 	bool getEntryName(char *fullname, char *entname);
 	friend void DOS_Shell::CMD_SUBST(char* args); 	
 	struct {
@@ -218,8 +238,19 @@ private:
 	Bit32u cwdDirCluster;
 	Bit32u dirPosition; /* Position in directory search */
 
-	Bit8u fatSectBuffer[1024];
-	Bit32u curFatSect;
+	/* The first copy of the FAT, changed sectors are written to all copies
+	   by flushFAT() before directory entries are updated and on unmount */
+	std::vector<Bit8u> fatTable;
+	std::vector<bool> fatSectDirty;
+	bool fatDirty;
+	/* One entry per cluster, set if the cluster is free */
+	std::vector<bool> freeClusters;
+	Bit32u freeCount;
+	Bit32u nextFreeHint;
+	/* Bumped when clusters are taken out of a chain, which makes the
+	   extent maps of the open files stale. Appending leaves them valid
+	   as they never record the end of a chain. */
+	Bit32u chainGeneration;
 };
 
 
@@ -320,6 +351,8 @@ struct isoDirEntry {
 #define IS_DIR(fileFlags)	(fileFlags & ISO_DIRECTORY)
 #define IS_HIDDEN(fileFlags)	(fileFlags & ISO_HIDDEN)
 #define ISO_MAX_HASH_TABLE_SIZE 	100
+#define ISO_CACHE_BLOCK_SECTORS	16
+#define ISO_CACHE_BLOCKS	32
 
 class isoDrive : public DOS_Drive {
 public:
@@ -344,6 +377,8 @@ public:
 	virtual bool isRemovable(void);
 	virtual Bits UnMount(void);
 	bool readSector(Bit8u *buffer, Bit32u sector);
+	bool readSectors(Bit8u *buffer, Bit32u sector, Bit32u num);
+	bool readFileSector(Bit8u **buffer, Bit32u sector);
 	virtual char const* GetLabel(void) {return discLabel;};
 	virtual void Activate(void);
 private:
@@ -356,6 +391,8 @@ private:
 	bool GetNextDirEntry(const int dirIterator, isoDirEntry* de);
 	void FreeDirIterator(const int dirIterator);
 	bool ReadCachedSector(Bit8u** buffer, const Bit32u sector);
+	Bitu findCacheBlock(Bit32u block);
+	Bitu loadCacheBlock(Bit32u block);
 	
 	struct DirIterator {
 		bool valid;
@@ -373,6 +410,17 @@ private:
 		Bit8u data[ISO_FRAMESIZE];
 	} sectorHashEntries[ISO_MAX_HASH_TABLE_SIZE];
 
+	/* file data, shared by all open files, in LRU order */
+	struct SectorCacheBlock {
+		Bit32u block;
+		Bit32u lru;
+		Bit32u valid;		/* sectors read from the start of the block, 0 if unused */
+		Bit8u data[ISO_CACHE_BLOCK_SECTORS*ISO_FRAMESIZE];
+	} sectorCache[ISO_CACHE_BLOCKS];
+	Bit32u sectorCacheLru;
+	Bitu sectorCacheLast;
+	Bit32u lastFileBlock;
+
 	bool iso;
 	bool dataCD;
 	isoDirEntry rootEntry;
@@ -353,6 +353,7 @@ static void DOSBOX_RealInit(Section * sec) {
 	MSG_Init(section);
 
 	MAPPER_AddHandler(DOSBOX_UnlockSpeed, MK_f12, MMOD2,"speedlock","Speedlock");
+	if (section->Get_bool("uncapped")) ticksLocked = true;
 	std::string cmd_machine;
 	if (control->cmdline->FindString("-machine",cmd_machine,true)){
 		//update value in config (else no matching against suggested values
@@ -421,6 +422,10 @@ void DOSBOX_Init(void) {
 	Pstring = secprop->Add_path("captures",Property::Changeable::Always,"capture");
 	Pstring->Set_help("Directory where things like wave, midi, screenshot get captured.");
 
+	Pbool = secprop->Add_bool("uncapped",Property::Changeable::OnlyAtStart,false);
+	Pbool->Set_help("Run the emulation as fast as possible instead of in real time, like the fast forward key does.\n"
+	                "Meant for unattended runs together with output=none, use it with a fixed cycles setting.");
+
 #if C_DEBUG
 	LOG_StartUp();
 #endif
@@ -450,6 +455,10 @@ void DOSBOX_Init(void) {
 	Pbool = secprop->Add_bool("aspect",Property::Changeable::Always,false);
 	Pbool->Set_help("Do aspect correction, if your output method doesn't support scaling this can slow things down!");
 
+	Pbool = secprop->Add_bool("threaded",Property::Changeable::OnlyAtStart,false);
+	Pbool->Set_help("Do the scaling on a separate thread. Can help with the more expensive scalers on multi-core machines,\n"
+	                "but adds up to a frame of latency.");
+
 	Pmulti = secprop->Add_multi("scaler",Property::Changeable::Always," ");
 	Pmulti->SetValue("normal2x");
 	Pmulti->Set_help("Scaler used to enlarge/enhance low resolution modes. If 'forced' is appended,\n"
@@ -484,6 +493,16 @@ void DOSBOX_Init(void) {
 	Pstring->Set_help("CPU Core used in emulation. auto will switch to dynamic if available and\n"
 		"appropriate.");
 
+#if (C_DYNREC)
+	Pint = secprop->Add_int("dynamic_cache",Property::Changeable::OnlyAtStart,8);
+	Pint->SetMinMax(1,256);
+	Pint->Set_help("Size of the code cache of the dynamic core in MB. Large protected mode games\n"
+		"may run smoother with a bigger cache.");
+	Pbool = secprop->Add_bool("dynamic_flags",Property::Changeable::WhenIdle,true);
+	Pbool->Set_help("Let the dynamic core skip computing condition flags that are overwritten\n"
+		"before being read. Disable to rule it out when a program misbehaves.");
+#endif
+
 	const char* cputype_values[] = { "auto", "386", "386_slow", "486_slow", "pentium_slow", "386_prefetch", 0};
 	Pstring = secprop->Add_string("cputype",Property::Changeable::Always,"auto");
 	Pstring->Set_values(cputype_values);
@@ -548,6 +567,12 @@ void DOSBOX_Init(void) {
 	Pint->SetMinMax(0,100);
 	Pint->Set_help("How many milliseconds of data to keep on top of the blocksize.");
 
+	const char* resamplers[] = { "linear", "sinc", 0 };
+	Pstring = secprop->Add_string("resampler",Property::Changeable::OnlyAtStart,"linear");
+	Pstring->Set_values(resamplers);
+	Pstring->Set_help("How devices running at another rate than the mixer get converted.\n"
+	                  "sinc is band-limited and has less aliasing, but costs more and delays the sound by a few samples.");
+
 	secprop=control->AddSection_prop("midi",&MIDI_Init,true);//done
 	secprop->AddInitFunction(&MPU401_Init,true);//done
 
@@ -613,6 +638,10 @@ void DOSBOX_Init(void) {
 	Pint->Set_values(oplrates);
 	Pint->Set_help("Sample rate of OPL music emulation. Use 49716 for highest quality (set the mixer rate accordingly).");
 
+	Pbool = secprop->Add_bool("oplthread",Property::Changeable::WhenIdle,false);
+	Pbool->Set_help("Do the OPL synthesis on a separate thread, only for the default/fast oplemu.\n"
+	                "Register writes keep their timing, but the music gets a millisecond more latency.");
+
 
 	secprop=control->AddSection_prop("gus",&GUS_Init,true); //done
 	Pbool = secprop->Add_bool("gus",Property::Changeable::WhenIdle,false);
@@ -762,6 +791,13 @@ void DOSBOX_Init(void) {
 	Pbool = secprop->Add_bool("umb",Property::Changeable::WhenIdle,true);
 	Pbool->Set_help("Enable UMB support.");
 
+	const char* imagecache_settings[] = { "true", "mmap", "false", 0};
+	Pstring = secprop->Add_string("imagecache",Property::Changeable::WhenIdle,"true");
+	Pstring->Set_values(imagecache_settings);
+	Pstring->Set_help("Cache the sectors of mounted disk images. Modified sectors are\n"
+		"written back to the image file within a second. mmap maps the\n"
+		"image files into memory instead, false disables the cache.");
+
 	secprop->AddInitFunction(&DOS_KeyboardLayout_Init,true);
 	Pstring = secprop->Add_string("keyboardlayout",Property::Changeable::WhenIdle, "auto");
 	Pstring->Set_help("Language code of the keyboard layout (or none).");
@@ -30,12 +30,51 @@
 #include "cross.h"
 #include "hardware.h"
 #include "support.h"
+#include "timer.h"
+#include "SDL_thread.h"
 
 #include "render_scalers.h"
 
 Render_t render;
 ScalerLineHandler_t RENDER_DrawLine;
 
+#define RENDER_FRAMES 3
+#define RENDER_NOFRAME RENDER_FRAMES
+
+/* Threaded rendering: the emulation only copies the source lines into one of the
+ * frame buffers, a separate thread does the change detection and scaling.
+ * All SDL calls stay on the emulation thread: the output gets locked before a
+ * frame is handed to the thread and is presented once the thread is done.
+ * The thread only sees the job and the scaler state, and only between posting
+ * todo and taking done. Everything else belongs to the emulation thread. */
+static struct {
+	bool enabled;
+	SDL_Thread * thread;
+	SDL_sem * todo;
+	SDL_sem * done;
+	volatile bool quit;
+	Bit8u * frames[RENDER_FRAMES];
+	Bit32u frameTicks[RENDER_FRAMES];	//When the frame was completed
+	Bitu frameSize;
+	Bitu write;							//Frame the emulation draws into
+	Bitu busy;							//Frame the thread is scaling
+	Bitu pending;						//Complete frame waiting for the thread
+	Bitu line;
+	bool discard;
+	ScalerLineHandler_t scaleLine;		//Line handler used by the thread
+	struct {
+		const Bit8u * src;
+		Bitu lines,pitch;
+	} job;								//Frame handed to the thread
+	struct {
+		Bitu frames,dropped;
+		Bitu latency,maxLatency;
+	} stats;
+} renderThread;
+
+/* Handler that processes the lines for the scalers, this is RENDER_DrawLine unless threaded */
+static ScalerLineHandler_t * RENDER_ScaleLine = &RENDER_DrawLine;
+
 static void RENDER_CallBack( GFX_CallBackFunctions_t function );
 
 static void Check_Palette(void) {
@@ -98,20 +137,17 @@ static void RENDER_EmptyLineHandler(const void * src) {
 
 static void RENDER_StartLineHandler(const void * s) {
 	if (s) {
-		const Bitu *src = (Bitu*)s;
-		Bitu *cache = (Bitu*)(render.scale.cacheRead);
-		for (Bits x=render.src.start;x>0;) {
-			if (GCC_UNLIKELY(src[0] != cache[0])) {
-				if (!GFX_StartUpdate( render.scale.outWrite, render.scale.outPitch )) {
-					RENDER_DrawLine = RENDER_EmptyLineHandler;
-					return;
-				}
-				render.scale.outWrite += render.scale.outPitch * Scaler_ChangedLines[0];
-				RENDER_DrawLine = render.scale.lineHandler;
-				RENDER_DrawLine( s );
+		Bitu size = render.src.start * sizeof(Bitu);
+		if (GCC_UNLIKELY(Scaler_SameBytes( s, render.scale.cacheRead, size ) < size)) {
+			/* The threaded renderer gets the output before the frame starts */
+			if (!renderThread.enabled && !GFX_StartUpdate( render.scale.outWrite, render.scale.outPitch )) {
+				RENDER_DrawLine = RENDER_EmptyLineHandler;
 				return;
 			}
-			x--; src++; cache++;
+			render.scale.outWrite += render.scale.outPitch * Scaler_ChangedLines[0];
+			*RENDER_ScaleLine = render.scale.lineHandler;
+			render.scale.lineHandler( s );
+			return;
 		}
 	}
 	render.scale.cacheRead += render.scale.cachePitch;
@@ -144,16 +180,8 @@ static void RENDER_ClearCacheHandler(const void * src) {
 	render.scale.lineHandler( src );
 }
 
-bool RENDER_StartUpdate(void) {
-	if (GCC_UNLIKELY(render.updating))
-		return false;
-	if (GCC_UNLIKELY(!render.active))
-		return false;
-	if (GCC_UNLIKELY(render.frameskip.count<render.frameskip.max)) {
-		render.frameskip.count++;
-		return false;
-	}
-	render.frameskip.count=0;
+/* Sets up the scaler state for a new frame, the output is already locked when threaded */
+static bool RENDER_StartFrame(void) {
 	if (render.scale.inMode == scalerMode8) {
 		Check_Palette();
 	}
@@ -164,35 +192,140 @@ bool RENDER_StartUpdate(void) {
 	render.scale.outPitch = 0;
 	Scaler_ChangedLines[0] = 0;
 	Scaler_ChangedLineIndex = 0;
+	if (renderThread.enabled && !GFX_StartUpdate( render.scale.outWrite, render.scale.outPitch ))
+		return false;
 	/* Clearing the cache will first process the line to make sure it's never the same */
 	if (GCC_UNLIKELY( render.scale.clearCache) ) {
 //		LOG_MSG("Clearing cache");
 		//Will always have to update the screen with this one anyway, so let's update already
-		if (GCC_UNLIKELY(!GFX_StartUpdate( render.scale.outWrite, render.scale.outPitch )))
+		if (GCC_UNLIKELY(!render.scale.outWrite && !GFX_StartUpdate( render.scale.outWrite, render.scale.outPitch )))
 			return false;
 		render.fullFrame = true;
 		render.scale.clearCache = false;
-		RENDER_DrawLine = RENDER_ClearCacheHandler;
+		*RENDER_ScaleLine = RENDER_ClearCacheHandler;
 	} else {
 		if (render.pal.changed) {
 			/* Assume pal changes always do a full screen update anyway */
-			if (GCC_UNLIKELY(!GFX_StartUpdate( render.scale.outWrite, render.scale.outPitch )))
+			if (GCC_UNLIKELY(!render.scale.outWrite && !GFX_StartUpdate( render.scale.outWrite, render.scale.outPitch )))
 				return false;
-			RENDER_DrawLine = render.scale.linePalHandler;
+			*RENDER_ScaleLine = render.scale.linePalHandler;
 			render.fullFrame = true;
 		} else {
-			RENDER_DrawLine = RENDER_StartLineHandler;
+			*RENDER_ScaleLine = RENDER_StartLineHandler;
 			if (GCC_UNLIKELY(CaptureState & (CAPTURE_IMAGE|CAPTURE_VIDEO))) 
 				render.fullFrame = true;
 			else
 				render.fullFrame = false;
 		}
 	}
+	return true;
+}
+
+static int RENDER_ThreadProc(void * /*data*/) {
+	for (;;) {
+		SDL_SemWait(renderThread.todo);
+		if (renderThread.quit) break;
+		const Bit8u * src = renderThread.job.src;
+		for (Bitu y=0;y<renderThread.job.lines;y++) {
+			renderThread.scaleLine( src );
+			src += renderThread.job.pitch;
+		}
+		SDL_SemPost(renderThread.done);
+	}
+	return 0;
+}
+
+static void RENDER_ThreadSubmit(Bitu frame) {
+	if (!RENDER_StartFrame()) {
+		renderThread.stats.dropped++;
+		return;
+	}
+	renderThread.busy = frame;
+	renderThread.job.src = renderThread.frames[frame];
+	renderThread.job.lines = render.src.height;
+	renderThread.job.pitch = render.scale.cachePitch;
+	SDL_SemPost(renderThread.todo);
+}
+
+/* Presents the frame the thread finished and starts on the next one */
+static void RENDER_ThreadCollect(bool wait) {
+	if (renderThread.busy == RENDER_NOFRAME)
+		return;
+	if (wait) SDL_SemWait(renderThread.done);
+	else if (SDL_SemTryWait(renderThread.done)) return;
+	Bit32u latency = GetTicks() - renderThread.frameTicks[renderThread.busy];
+	renderThread.busy = RENDER_NOFRAME;
+	GFX_EndUpdate( Scaler_ChangedLines );
+	renderThread.stats.frames++;
+	renderThread.stats.latency += latency;
+	if (latency > renderThread.stats.maxLatency) renderThread.stats.maxLatency = latency;
+	if (!wait && renderThread.pending != RENDER_NOFRAME) {
+		Bitu frame = renderThread.pending;
+		renderThread.pending = RENDER_NOFRAME;
+		RENDER_ThreadSubmit(frame);
+	}
+}
+
+/* Waits till the thread stops using the output, frames that didn't start yet are dropped */
+static void RENDER_ThreadSync(void) {
+	if (!renderThread.enabled)
+		return;
+	RENDER_ThreadCollect(true);
+	if (renderThread.pending != RENDER_NOFRAME) {
+		renderThread.pending = RENDER_NOFRAME;
+		renderThread.stats.dropped++;
+	}
+}
+
+static void RENDER_CopyLineHandler(const void * s) {
+	if (GCC_UNLIKELY(renderThread.line >= render.src.height))
+		return;
+	Bit8u * dst = renderThread.frames[renderThread.write] + renderThread.line * render.scale.cachePitch;
+	if (s) memcpy( dst, s, render.scale.cachePitch );
+	renderThread.line++;
+}
+
+bool RENDER_StartUpdate(void) {
+	if (GCC_UNLIKELY(render.updating))
+		return false;
+	if (GCC_UNLIKELY(!render.active))
+		return false;
+	if (GCC_UNLIKELY(render.frameskip.count<render.frameskip.max)) {
+		render.frameskip.count++;
+		return false;
+	}
+	render.frameskip.count=0;
+	if (GCC_UNLIKELY(render.nodisplay)) {
+		/* Nothing gets shown, only keep the source cache filled for capturing */
+		if (!(CaptureState & (CAPTURE_IMAGE|CAPTURE_VIDEO)))
+			return false;
+		render.scale.cacheRead = (Bit8u*)&scalerSourceCache;
+		render.scale.outWrite = 0;
+		RENDER_DrawLine = RENDER_FinishLineHandler;
+		render.updating = true;
+		return true;
+	}
+	if (renderThread.enabled) {
+		RENDER_ThreadCollect(false);
+		/* Take a frame that isn't being scaled or waiting for it */
+		renderThread.write = 0;
+		while (renderThread.write == renderThread.busy || renderThread.write == renderThread.pending)
+			renderThread.write++;
+		renderThread.line = 0;
+		renderThread.discard = false;
+		render.fullFrame = true;
+		RENDER_DrawLine = RENDER_CopyLineHandler;
+		render.updating = true;
+		return true;
+	}
+	if (!RENDER_StartFrame())
+		return false;
 	render.updating = true;
 	return true;
 }
 
 static void RENDER_Halt( void ) {
+	RENDER_ThreadSync();
 	RENDER_DrawLine = RENDER_EmptyLineHandler;
 	GFX_EndUpdate( 0 );
 	render.updating=false;
@@ -204,6 +337,34 @@ void RENDER_EndUpdate( bool abort ) {
 	if (GCC_UNLIKELY(!render.updating))
 		return;
 	RENDER_DrawLine = RENDER_EmptyLineHandler;
+	if (renderThread.enabled && !render.nodisplay) {
+		render.updating=false;
+		if (abort || renderThread.discard || renderThread.line < render.src.height)
+			return;
+		Bitu frame = renderThread.write;
+		renderThread.frameTicks[frame] = GetTicks();
+		if (GCC_UNLIKELY(CaptureState & (CAPTURE_IMAGE|CAPTURE_VIDEO))) {
+			Bitu flags = 0;
+			if (render.src.dblw != render.src.dblh) {
+				if (render.src.dblw) flags|=CAPTURE_FLAG_DBLW;
+				if (render.src.dblh) flags|=CAPTURE_FLAG_DBLH;
+			}
+			float fps = render.src.fps;
+			if (render.frameskip.max)
+				fps /= 1+render.frameskip.max;
+			CAPTURE_AddImage( render.src.width, render.src.height, render.src.bpp, render.scale.cachePitch,
+				flags, fps, renderThread.frames[frame], (Bit8u*)&render.pal.rgb );
+		}
+		RENDER_ThreadCollect(false);
+		if (renderThread.busy == RENDER_NOFRAME) {
+			RENDER_ThreadSubmit(frame);
+		} else {
+			/* Thread is still busy, a newer frame replaces the one that is waiting */
+			if (renderThread.pending != RENDER_NOFRAME) renderThread.stats.dropped++;
+			renderThread.pending = frame;
+		}
+		return;
+	}
 	if (GCC_UNLIKELY(CaptureState & (CAPTURE_IMAGE|CAPTURE_VIDEO))) {
 		Bitu pitch, flags;
 		flags = 0;
@@ -258,6 +419,7 @@ static Bitu MakeAspectTable(Bitu skip,Bitu height,double scaley,Bitu miny) {
 
 
 static void RENDER_Reset( void ) {
+	RENDER_ThreadSync();
 	Bitu width=render.src.width;
 	Bitu height=render.src.height;
 	bool dblw=render.src.dblw;
@@ -430,6 +592,7 @@ forcenormal:
 		render.scale.outMode = scalerMode32;
 	else 
 		E_Exit("Failed to create a rendering output");
+	render.nodisplay = (gfx_flags & GFX_NODISPLAY) != 0;
 	ScalerLineBlock_t *lineBlock;
 	if (gfx_flags & GFX_HARDWARE) {
 #if RENDER_USE_ADVANCED_SCALERS>1
@@ -490,8 +653,22 @@ forcenormal:
 	render.pal.last = 255;
 	render.pal.changed = false;
 	memset(render.pal.modified, 0, sizeof(render.pal.modified));
-	//Finish this frame using a copy only handler
-	RENDER_DrawLine = RENDER_FinishLineHandler;
+	if (renderThread.enabled) {
+		Bitu size = render.src.height * render.scale.cachePitch;
+		if (size > renderThread.frameSize) {
+			for (Bitu i=0;i<RENDER_FRAMES;i++) {
+				delete[] renderThread.frames[i];
+				renderThread.frames[i] = new Bit8u[size];
+			}
+			renderThread.frameSize = size;
+		}
+		//The frame being copied has the old size, so drop it
+		renderThread.discard = true;
+		RENDER_DrawLine = RENDER_EmptyLineHandler;
+	} else {
+		//Finish this frame using a copy only handler
+		RENDER_DrawLine = RENDER_FinishLineHandler;
+	}
 	render.scale.outWrite = 0;
 	/* Signal the next frame to first reinit the cache */
 	render.scale.clearCache = true;
@@ -506,8 +683,12 @@ static void RENDER_CallBack( GFX_CallBackFunctions_t function ) {
 		render.scale.clearCache = true;
 		return;
 	} else if ( function == GFX_CallBackReset) {
+		RENDER_ThreadSync();
 		GFX_EndUpdate( 0 );	
 		RENDER_Reset();
+	} else if (function == GFX_CallBackSync) {
+		RENDER_ThreadSync();
+		return;
 	} else {
 		E_Exit("Unhandled GFX_CallBackReset %d", function );
 	}
@@ -563,6 +744,29 @@ static void ChangeScaler(bool pressed) {
 	RENDER_CallBack( GFX_CallBackReset );
 } */
 
+static void RENDER_ShutDown(Section * /*sec*/) {
+	if (!renderThread.enabled)
+		return;
+	RENDER_ThreadSync();
+	renderThread.quit = true;
+	SDL_SemPost(renderThread.todo);
+	SDL_WaitThread(renderThread.thread,0);
+	SDL_DestroySemaphore(renderThread.todo);
+	SDL_DestroySemaphore(renderThread.done);
+	for (Bitu i=0;i<RENDER_FRAMES;i++) {
+		delete[] renderThread.frames[i];
+		renderThread.frames[i] = 0;
+	}
+	renderThread.frameSize = 0;
+	renderThread.enabled = false;
+	RENDER_ScaleLine = &RENDER_DrawLine;
+	RENDER_DrawLine = RENDER_EmptyLineHandler;
+	if (renderThread.stats.frames)
+		LOG_MSG("RENDER:Thread presented %d frames, dropped %d, latency avg %d ms max %d ms",
+			renderThread.stats.frames,renderThread.stats.dropped,
+			renderThread.stats.latency / renderThread.stats.frames,renderThread.stats.maxLatency);
+}
+
 void RENDER_Init(Section * sec) {
 	Section_prop * section=static_cast<Section_prop *>(sec);
 
@@ -623,7 +827,27 @@ void RENDER_Init(Section * sec) {
 				   render.scale.forced))
 		RENDER_CallBack( GFX_CallBackReset );
 
-	if(!running) render.updating=true;
+	if(!running) {
+		render.updating=true;
+		Scaler_Init();
+		renderThread.busy = renderThread.pending = RENDER_NOFRAME;
+		renderThread.enabled = section->Get_bool("threaded");
+		if (renderThread.enabled) {
+			renderThread.todo = SDL_CreateSemaphore(0);
+			renderThread.done = SDL_CreateSemaphore(0);
+			renderThread.scaleLine = RENDER_EmptyLineHandler;
+			RENDER_ScaleLine = &renderThread.scaleLine;
+			renderThread.thread = SDL_CreateThread(&RENDER_ThreadProc,0);
+			if (!renderThread.thread) {
+				LOG_MSG("RENDER:Can't start render thread, rendering on the main thread");
+				SDL_DestroySemaphore(renderThread.todo);
+				SDL_DestroySemaphore(renderThread.done);
+				RENDER_ScaleLine = &RENDER_DrawLine;
+				renderThread.enabled = false;
+			}
+		}
+		sec->AddDestroyFunction(&RENDER_ShutDown,false);
+	}
 	running = true;
 
 	MAPPER_AddHandler(DecreaseFrameSkip,MK_f7,MMOD1,"decfskip","Dec Fskip");
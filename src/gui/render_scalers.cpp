@@ -25,6 +25,16 @@
 #include "render.h"
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCALER_SSE2 1
+#include <emmintrin.h>
+#if (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) || defined(__clang__)
+/* AVX2 gets compiled with a function attribute and only used when the cpu has it */
+#define SCALER_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
 Bit8u Scaler_Aspect[SCALER_MAXHEIGHT];
 Bit16u Scaler_ChangedLines[SCALER_MAXHEIGHT];
 Bitu Scaler_ChangedLineIndex;
@@ -61,6 +71,64 @@ static INLINE void BituMove( void *_dst, const void * _src, Bitu size) {
 		dst[x] = src[x];
 }
 
+static Bitu Scaler_SameBytesBitu(const void *_src,const void *_cache,Bitu size) {
+	const Bitu *src=(const Bitu *)_src;
+	const Bitu *cache=(const Bitu *)_cache;
+	Bitu x=0;
+	while (x<size && src[0]==cache[0]) {
+		x+=sizeof(Bitu);src++;cache++;
+	}
+	return x;
+}
+
+#if SCALER_SSE2
+static Bitu Scaler_SameBytesSSE2(const void *_src,const void *_cache,Bitu size) {
+	const Bit8u *src=(const Bit8u *)_src;
+	const Bit8u *cache=(const Bit8u *)_cache;
+	Bitu x=0;
+	for (;x+16<=size;x+=16) {
+		__m128i a=_mm_loadu_si128((const __m128i *)(src+x));
+		__m128i b=_mm_loadu_si128((const __m128i *)(cache+x));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(a,b)) != 0xffff)
+			break;
+	}
+	/* Find the exact Bitu that differs, also handles the tail */
+	return x+Scaler_SameBytesBitu(src+x,cache+x,size-x);
+}
+#endif
+
+#if SCALER_AVX2
+__attribute__((target("avx2")))
+static Bitu Scaler_SameBytesAVX2(const void *_src,const void *_cache,Bitu size) {
+	const Bit8u *src=(const Bit8u *)_src;
+	const Bit8u *cache=(const Bit8u *)_cache;
+	Bitu x=0;
+	for (;x+32<=size;x+=32) {
+		__m256i a=_mm256_loadu_si256((const __m256i *)(src+x));
+		__m256i b=_mm256_loadu_si256((const __m256i *)(cache+x));
+		if ((Bit32u)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a,b)) != 0xffffffff)
+			break;
+	}
+	return x+Scaler_SameBytesBitu(src+x,cache+x,size-x);
+}
+#endif
+
+#if SCALER_SSE2
+ScalerCompareHandler_t Scaler_SameBytes = Scaler_SameBytesSSE2;
+#else
+ScalerCompareHandler_t Scaler_SameBytes = Scaler_SameBytesBitu;
+#endif
+
+void Scaler_Init(void) {
+#if SCALER_AVX2
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		Scaler_SameBytes = Scaler_SameBytesAVX2;
+		LOG(LOG_MISC,LOG_NORMAL)("RENDER:Using AVX2 line compare");
+	}
+#endif
+}
+
 static INLINE void ScalerAddLines( Bitu changed, Bitu count ) {
 	if ((Scaler_ChangedLineIndex & 1) == changed ) {
 		Scaler_ChangedLines[Scaler_ChangedLineIndex] += count;
@@ -61,11 +61,15 @@ typedef enum scalerOperation {
 
 typedef void (*ScalerLineHandler_t)(const void *src);
 typedef void (*ScalerComplexHandler_t)(void);
+/* Returns how many leading bytes of both lines are equal, counted in whole Bitu's */
+typedef Bitu (*ScalerCompareHandler_t)(const void *src,const void *cache,Bitu size);
 
 extern Bit8u Scaler_Aspect[];
 extern Bit8u diff_table[];
 extern Bitu Scaler_ChangedLineIndex;
 extern Bit16u Scaler_ChangedLines[];
+extern ScalerCompareHandler_t Scaler_SameBytes;
+void Scaler_Init(void);
 #if RENDER_USE_ADVANCED_SCALERS>1
 /* Not entirely happy about those +2's since they make a non power of 2, with muls instead of shift */
 typedef Bit8u scalerChangeCache_t [SCALER_COMPLEXHEIGHT][SCALER_COMPLEXWIDTH / SCALER_BLOCKSIZE] ;
@@ -54,10 +54,12 @@ static void conc4d(SCALERNAME,SBPP,DBPP,R)(const void *s) {
 #else 
 	for (Bits x=render.src.width;x>0;) {
 		if (*(Bitu const*)src == *(Bitu*)cache) {
-			x-=(sizeof(Bitu)/sizeof(SRCTYPE));
-			src+=(sizeof(Bitu)/sizeof(SRCTYPE));
-			cache+=(sizeof(Bitu)/sizeof(SRCTYPE));
-			line0+=(sizeof(Bitu)/sizeof(SRCTYPE))*SCALERWIDTH;
+			/* Skip the complete unchanged run in one go */
+			Bitu same = Scaler_SameBytes( src, cache, x*sizeof(SRCTYPE) ) / sizeof(SRCTYPE);
+			x-=same;
+			src+=same;
+			cache+=same;
+			line0+=same*SCALERWIDTH;
 #endif
 		} else {
 #if defined(SCALERLINEAR)
@@ -76,6 +78,21 @@ static void conc4d(SCALERNAME,SBPP,DBPP,R)(const void *s) {
 #endif
 #endif //defined(SCALERLINEAR)
 			hadChange = 1;
+#if defined(SCALERBLOCK)
+			if (x >= 32) {
+				SCALERBLOCK(src,cache,line0,SCALERWIDTH);
+#if (SCALERHEIGHT > 1) 
+				BituMove(line1,line0,32*SCALERWIDTH*PSIZE);
+				line1 += 32*SCALERWIDTH;
+#endif
+#if (SCALERHEIGHT > 2) 
+				BituMove(line2,line0,32*SCALERWIDTH*PSIZE);
+				line2 += 32*SCALERWIDTH;
+#endif
+				src+=32;cache+=32;x-=32;
+				line0 += 32*SCALERWIDTH;
+			} else
+#endif
 			for (Bitu i = x > 32 ? 32 : x;i>0;i--,x--) {
 				const SRCTYPE S = *src;
 				*cache = S;
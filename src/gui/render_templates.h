@@ -212,6 +212,54 @@ static void conc3d(Cache,SBPP,DBPP) (const void * s) {
 #endif
 
 
+#if SCALER_SSE2 && (DBPP > 8)
+/* Expand 32 changed source pixels and write them scaled to line0.
+ * Palette entries are looked up one lane at a time, the stores are
+ * 16 bytes wide. */
+static INLINE void conc3d(NormalBlock,SBPP,DBPP)(const SRCTYPE *src,SRCTYPE *cache,PTYPE *line0,const Bitu width) {
+	for (Bitu i=0;i<32*sizeof(SRCTYPE);i+=16)
+		_mm_storeu_si128((__m128i *)((Bit8u *)cache+i),_mm_loadu_si128((const __m128i *)((const Bit8u *)src+i)));
+	for (Bitu x=0;x<32;x+=16/PSIZE,src+=16/PSIZE) {
+#if (SBPP == DBPP)
+		const __m128i v=_mm_loadu_si128((const __m128i *)src);
+#elif (DBPP == 32)
+		const __m128i v=_mm_set_epi32(PMAKE(src[3]),PMAKE(src[2]),PMAKE(src[1]),PMAKE(src[0]));
+#else
+		const __m128i v=_mm_set_epi16((short)PMAKE(src[7]),(short)PMAKE(src[6]),(short)PMAKE(src[5]),(short)PMAKE(src[4]),
+			(short)PMAKE(src[3]),(short)PMAKE(src[2]),(short)PMAKE(src[1]),(short)PMAKE(src[0]));
+#endif
+		__m128i *dst=(__m128i *)(line0+x*width);
+		if (width==1) {
+			_mm_storeu_si128(dst,v);
+		} else if (width==2) {
+#if (DBPP == 32)
+			_mm_storeu_si128(dst+0,_mm_unpacklo_epi32(v,v));
+			_mm_storeu_si128(dst+1,_mm_unpackhi_epi32(v,v));
+#else
+			_mm_storeu_si128(dst+0,_mm_unpacklo_epi16(v,v));
+			_mm_storeu_si128(dst+1,_mm_unpackhi_epi16(v,v));
+#endif
+		} else {
+#if (DBPP == 32)
+			_mm_storeu_si128(dst+0,_mm_shuffle_epi32(v,_MM_SHUFFLE(1,0,0,0)));
+			_mm_storeu_si128(dst+1,_mm_shuffle_epi32(v,_MM_SHUFFLE(2,2,1,1)));
+			_mm_storeu_si128(dst+2,_mm_shuffle_epi32(v,_MM_SHUFFLE(3,3,3,2)));
+#else
+			/* 0 0 0 1 1 1 2 2 | 2 3 3 3 4 4 4 5 | 5 5 6 6 6 7 7 7 */
+			const __m128i h=_mm_shufflehi_epi16(v,_MM_SHUFFLE(1,0,0,0));
+			_mm_storeu_si128(dst+0,_mm_unpacklo_epi64(_mm_shufflelo_epi16(v,_MM_SHUFFLE(1,0,0,0)),
+				_mm_shufflelo_epi16(v,_MM_SHUFFLE(2,2,1,1))));
+			_mm_storeu_si128(dst+1,_mm_unpacklo_epi64(_mm_shufflelo_epi16(v,_MM_SHUFFLE(3,3,3,2)),
+				_mm_unpackhi_epi64(h,h)));
+			_mm_storeu_si128(dst+2,_mm_unpackhi_epi64(_mm_shufflehi_epi16(v,_MM_SHUFFLE(2,2,1,1)),
+				_mm_shufflehi_epi16(v,_MM_SHUFFLE(3,3,3,2))));
+#endif
+		}
+	}
+}
+#define SCALERBLOCK conc3d(NormalBlock,SBPP,DBPP)
+#endif
+
 /* Simple scalers */
 #define SCALERNAME		Normal1x
 #define SCALERWIDTH		1
@@ -280,6 +328,7 @@ static void conc3d(Cache,SBPP,DBPP) (const void * s) {
 #undef SCALERWIDTH
 #undef SCALERHEIGHT
 #undef SCALERFUNC
+#undef SCALERBLOCK
 
 #if (DBPP > 8)
 
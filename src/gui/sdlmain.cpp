@@ -49,6 +49,7 @@
 #include "cpu.h"
 #include "cross.h"
 #include "control.h"
+#include "dos_inc.h"
 
 #define MAPPERFILE "mapper-" VERSION ".map"
 //#define DISABLE_JOYSTICK
@@ -131,7 +132,8 @@ enum SCREEN_TYPES	{
 	SCREEN_SURFACE,
 	SCREEN_SURFACE_DDRAW,
 	SCREEN_OVERLAY,
-	SCREEN_OPENGL
+	SCREEN_OPENGL,
+	SCREEN_NONE
 };
 
 enum PRIORITY_LEVELS {
@@ -429,6 +431,11 @@ check_gotbpp:
 		flags&=~(GFX_CAN_8|GFX_CAN_15|GFX_CAN_16);
 		break;
 #endif
+	case SCREEN_NONE:
+		//Nothing gets drawn, just pick the mode every scaler supports
+		flags|=GFX_CAN_32|GFX_NODISPLAY;
+		flags&=~(GFX_CAN_8|GFX_CAN_15|GFX_CAN_16);
+		break;
 	default:
 		goto check_surface;
 		break;
@@ -511,9 +518,16 @@ static SDL_Surface * GFX_SetupSurfaceScaled(Bit32u sdl_flags, Bit32u bpp) {
 	}
 }
 
-void GFX_TearDown(void) {
+/* The renderer might still be drawing into the surface from its own thread */
+static void GFX_FinishUpdate(void) {
+	if (sdl.updating && sdl.draw.callback)
+		(sdl.draw.callback)( GFX_CallBackSync );
 	if (sdl.updating)
 		GFX_EndUpdate( 0 );
+}
+
+void GFX_TearDown(void) {
+	GFX_FinishUpdate();
 
 	if (sdl.blit.surface) {
 		SDL_FreeSurface(sdl.blit.surface);
@@ -522,8 +536,7 @@ void GFX_TearDown(void) {
 }
 
 Bitu GFX_SetSize(Bitu width,Bitu height,Bitu flags,double scalex,double scaley,GFX_CallBack_t callback) {
-	if (sdl.updating)
-		GFX_EndUpdate( 0 );
+	GFX_FinishUpdate();
 
 	sdl.draw.width=width;
 	sdl.draw.height=height;
@@ -767,6 +780,10 @@ dosurface:
 	break;
 		}//OPENGL
 #endif	//C_OPENGL
+	case SCREEN_NONE:
+		sdl.desktop.type=SCREEN_NONE;
+		retFlags = GFX_CAN_32 | GFX_NODISPLAY;
+		break;
 	default:
 		goto dosurface;
 		break;
@@ -1067,6 +1084,7 @@ Bitu GFX_GetRGB(Bit8u red,Bit8u green,Bit8u blue) {
 #endif
 		}
 	case SCREEN_OPENGL:
+	case SCREEN_NONE:
 //		return ((red << 0) | (green << 8) | (blue << 16)) | (255 << 24);
 		//USE BGRA
 		return ((blue << 0) | (green << 8) | (red << 16)) | (255 << 24);
@@ -1075,8 +1093,7 @@ Bitu GFX_GetRGB(Bit8u red,Bit8u green,Bit8u blue) {
 }
 
 void GFX_Stop() {
-	if (sdl.updating)
-		GFX_EndUpdate( 0 );
+	GFX_FinishUpdate();
 	sdl.active=false;
 }
 
@@ -1169,6 +1186,8 @@ static void OutputString(Bitu x,Bitu y,const char * text,Bit32u color,Bit32u col
 //extern void UI_Run(bool);
 void Restart(bool pressed);
 
+static void GUI_AddHandlers(void);
+
 static void GUI_StartUp(Section * sec) {
 	sec->AddDestroyFunction(&GUI_ShutDown);
 	Section_prop * section=static_cast<Section_prop *>(sec);
@@ -1307,6 +1326,9 @@ static void GUI_StartUp(Section * sec) {
 #endif
 	} else if (output == "overlay") {
 		sdl.desktop.want_type=SCREEN_OVERLAY;
+	} else if (output == "none") {
+		sdl.desktop.want_type=SCREEN_NONE;
+		sdl.desktop.fullscreen=false;
 #if C_OPENGL
 	} else if (output == "opengl") {
 		sdl.desktop.want_type=SCREEN_OPENGL;
@@ -1353,6 +1375,14 @@ static void GUI_StartUp(Section * sec) {
 	} /* OPENGL is requested end */
 
 #endif	//OPENGL
+	if (sdl.desktop.want_type==SCREEN_NONE) {
+		/* No window, the VGA is still emulated but nothing gets drawn */
+		sdl.surface=0;
+		sdl.desktop.bpp=32;
+		GFX_Stop();
+		GUI_AddHandlers();
+		return;
+	}
 	/* Initialize screen for first time */
 	sdl.surface=SDL_SetVideoMode_Wrap(640,400,0,0);
 	if (sdl.surface == NULL) E_Exit("Could not initialize video: %s",SDL_GetError());
@@ -1434,7 +1464,10 @@ static void GUI_StartUp(Section * sec) {
 		delete [] tmpbufp;
 
 	}
+	GUI_AddHandlers();
+}
 
+static void GUI_AddHandlers(void) {
 	/* Get some Event handlers */
 	MAPPER_AddHandler(KillSwitch,MK_f9,MMOD1,"shutdown","ShutDown");
 	MAPPER_AddHandler(CaptureMouse,MK_f10,MMOD1,"capmouse","Cap Mouse");
@@ -1744,7 +1777,7 @@ void Config_Add_SDL() {
 	                  "(output=surface does not!)");
 
 	const char* outputs[] = {
-		"surface", "overlay",
+		"surface", "overlay", "none",
 #if C_OPENGL
 		"opengl", "openglnb",
 #endif
@@ -1753,7 +1786,8 @@ void Config_Add_SDL() {
 #endif
 		0 };
 	Pstring = sdl_sec->Add_string("output",Property::Changeable::Always,"surface");
-	Pstring->Set_help("What video system to use for output.");
+	Pstring->Set_help("What video system to use for output.\n"
+	                  "none opens no window at all, the video card is still emulated. Useful for running programs unattended.");
 	Pstring->Set_values(outputs);
 
 	Pbool = sdl_sec->Add_bool("autolock",Property::Changeable::Always,true);
@@ -1972,6 +2006,7 @@ static void erasemapperfile() {
 
 //extern void UI_Init(void);
 int main(int argc, char* argv[]) {
+	int exit_code = 0;
 	try {
 		CommandLine com_line(argc,argv);
 		Config myconf(&com_line);
@@ -2043,61 +2078,6 @@ int main(int argc, char* argv[]) {
 	LOG_MSG("Copyright 2002-2019 DOSBox Team, published under GNU GPL.");
 	LOG_MSG("---");
 
-	/* Init SDL */
-#if SDL_VERSION_ATLEAST(1, 2, 14)
-	/* Or debian/ubuntu with older libsdl version as they have done this themselves, but then differently.
-	 * with this variable they will work correctly. I've only tested the 1.2.14 behaviour against the windows version
-	 * of libsdl
-	 */
-	putenv(const_cast<char*>("SDL_DISABLE_LOCK_KEYS=1"));
-#endif
-	// Don't init timers, GetTicks seems to work fine and they can use a fair amount of power (Macs again) 
-	// Please report problems with audio and other things.
-	if ( SDL_Init( SDL_INIT_AUDIO|SDL_INIT_VIDEO | /*SDL_INIT_TIMER |*/ SDL_INIT_CDROM
-		|SDL_INIT_NOPARACHUTE
-		) < 0 ) E_Exit("Can't init SDL %s",SDL_GetError());
-	sdl.inited = true;
-
-#ifndef DISABLE_JOYSTICK
-	//Initialise Joystick separately. This way we can warn when it fails instead
-	//of exiting the application
-	if( SDL_InitSubSystem(SDL_INIT_JOYSTICK) < 0 ) LOG_MSG("Failed to init joystick support");
-#endif
-
-	sdl.laltstate = SDL_KEYUP;
-	sdl.raltstate = SDL_KEYUP;
-
-#if defined (WIN32)
-#if SDL_VERSION_ATLEAST(1, 2, 10)
-		sdl.using_windib=true;
-#else
-		sdl.using_windib=false;
-#endif
-		char sdl_drv_name[128];
-		if (getenv("SDL_VIDEODRIVER")==NULL) {
-			if (SDL_VideoDriverName(sdl_drv_name,128)!=NULL) {
-				sdl.using_windib=false;
-				if (strcmp(sdl_drv_name,"directx")!=0) {
-					SDL_QuitSubSystem(SDL_INIT_VIDEO);
-					putenv("SDL_VIDEODRIVER=directx");
-					if (SDL_InitSubSystem(SDL_INIT_VIDEO)<0) {
-						putenv("SDL_VIDEODRIVER=windib");
-						if (SDL_InitSubSystem(SDL_INIT_VIDEO)<0) E_Exit("Can't init SDL Video %s",SDL_GetError());
-						sdl.using_windib=true;
-					}
-				}
-			}
-		} else {
-			char* sdl_videodrv = getenv("SDL_VIDEODRIVER");
-			if (strcmp(sdl_videodrv,"directx")==0) sdl.using_windib = false;
-			else if (strcmp(sdl_videodrv,"windib")==0) sdl.using_windib = true;
-		}
-		if (SDL_VideoDriverName(sdl_drv_name,128)!=NULL) {
-			if (strcmp(sdl_drv_name,"windib")==0) LOG_MSG("SDL_Init: Starting up with SDL windib video driver.\n          Try to update your video card and directx drivers!");
-		}
-#endif
-	sdl.num_joysticks=SDL_NumJoysticks();
-
 	/* Parse configuration files */
 	std::string config_file, config_path, config_combined;
 	Cross::GetPlatformConfigDir(config_path);
@@ -2161,15 +2141,72 @@ int main(int argc, char* argv[]) {
 #if (ENVIRON_LINKED)
 		control->ParseEnv(environ);
 #endif
+
+	/* Init SDL */
+#if SDL_VERSION_ATLEAST(1, 2, 14)
+	/* Or debian/ubuntu with older libsdl version as they have done this themselves, but then differently.
+	 * with this variable they will work correctly. I've only tested the 1.2.14 behaviour against the windows version
+	 * of libsdl
+	 */
+	putenv(const_cast<char*>("SDL_DISABLE_LOCK_KEYS=1"));
+#endif
+	/* Without a window SDL's dummy video driver is enough for event handling, so no display is needed */
+	Section_prop * sdl_sec=static_cast<Section_prop *>(control->GetSection("sdl"));
+	if (!strcmp(sdl_sec->Get_string("output"),"none") && getenv("SDL_VIDEODRIVER")==NULL)
+		putenv(const_cast<char*>("SDL_VIDEODRIVER=dummy"));
+	// Don't init timers, GetTicks seems to work fine and they can use a fair amount of power (Macs again) 
+	// Please report problems with audio and other things.
+	if ( SDL_Init( SDL_INIT_AUDIO|SDL_INIT_VIDEO | /*SDL_INIT_TIMER |*/ SDL_INIT_CDROM
+		|SDL_INIT_NOPARACHUTE
+		) < 0 ) E_Exit("Can't init SDL %s",SDL_GetError());
+	sdl.inited = true;
+
+#ifndef DISABLE_JOYSTICK
+	//Initialise Joystick separately. This way we can warn when it fails instead
+	//of exiting the application
+	if( SDL_InitSubSystem(SDL_INIT_JOYSTICK) < 0 ) LOG_MSG("Failed to init joystick support");
+#endif
+
+	sdl.laltstate = SDL_KEYUP;
+	sdl.raltstate = SDL_KEYUP;
+
+#if defined (WIN32)
+#if SDL_VERSION_ATLEAST(1, 2, 10)
+		sdl.using_windib=true;
+#else
+		sdl.using_windib=false;
+#endif
+		char sdl_drv_name[128];
+		if (getenv("SDL_VIDEODRIVER")==NULL) {
+			if (SDL_VideoDriverName(sdl_drv_name,128)!=NULL) {
+				sdl.using_windib=false;
+				if (strcmp(sdl_drv_name,"directx")!=0) {
+					SDL_QuitSubSystem(SDL_INIT_VIDEO);
+					putenv("SDL_VIDEODRIVER=directx");
+					if (SDL_InitSubSystem(SDL_INIT_VIDEO)<0) {
+						putenv("SDL_VIDEODRIVER=windib");
+						if (SDL_InitSubSystem(SDL_INIT_VIDEO)<0) E_Exit("Can't init SDL Video %s",SDL_GetError());
+						sdl.using_windib=true;
+					}
+				}
+			}
+		} else {
+			char* sdl_videodrv = getenv("SDL_VIDEODRIVER");
+			if (strcmp(sdl_videodrv,"directx")==0) sdl.using_windib = false;
+			else if (strcmp(sdl_videodrv,"windib")==0) sdl.using_windib = true;
+		}
+		if (SDL_VideoDriverName(sdl_drv_name,128)!=NULL) {
+			if (strcmp(sdl_drv_name,"windib")==0) LOG_MSG("SDL_Init: Starting up with SDL windib video driver.\n          Try to update your video card and directx drivers!");
+		}
+#endif
+	sdl.num_joysticks=SDL_NumJoysticks();
 //		UI_Init();
 //		if (control->cmdline->FindExist("-startui")) UI_Run(false);
 		/* Init all the sections */
 		control->Init();
 		/* Some extra SDL Functions */
-		Section_prop * sdl_sec=static_cast<Section_prop *>(control->GetSection("sdl"));
-
 		if (control->cmdline->FindExist("-fullscreen") || sdl_sec->Get_bool("fullscreen")) {
-			if(!sdl.desktop.fullscreen) { //only switch if not already in fullscreen
+			if(!sdl.desktop.fullscreen && sdl.desktop.want_type!=SCREEN_NONE) { //only switch if not already in fullscreen
 				GFX_SwitchFullScreen();
 			}
 		}
@@ -2179,6 +2216,8 @@ int main(int argc, char* argv[]) {
 		if (control->cmdline->FindExist("-startmapper")) MAPPER_RunInternal();
 		/* Start up main machine */
 		control->StartUp();
+		/* Hand the errorlevel of the last DOS program to the host */
+		if (control->cmdline->FindExist("-exitcode")) exit_code = dos.return_code;
 		/* Shutdown everything */
 	} catch (char * error) {
 #if defined (WIN32)
@@ -2212,7 +2251,7 @@ int main(int argc, char* argv[]) {
 	SDL_ShowCursor(SDL_ENABLE);
 
 	SDL_Quit();//Let's hope sdl will quit as well when it catches an exception
-	return 0;
+	return exit_code;
 }
 
 void GFX_GetSize(int &width, int &height, bool &fullscreen) {
@@ -21,7 +21,10 @@
 #include <string.h>
 #include <math.h>
 #include <sys/types.h>
+#include <vector>
 #include "adlib.h"
+#include "SDL.h"
+#include "SDL_thread.h"
 
 #include "setup.h"
 #include "mapper.h"
@@ -165,6 +168,186 @@ struct Handler : public Adlib::Handler {
 }
 
 
+/*
+	dbopl running on its own thread. The register writes get queued with the time they happened,
+	every mixer callback hands the writes and the amount of samples for that period to the thread
+	and takes the samples it made for the previous period. This adds a little over a tick of latency.
+*/
+namespace DBOPLThreaded {
+
+struct RegWrite {
+	double time;
+	Bit32u addr;
+	Bit8u val;
+};
+
+struct Handler : public Adlib::Handler {
+	DBOPL::Handler opl;
+	Bit8u opl3Active;				//Address decoding state including the queued writes
+	std::vector<RegWrite> pending;	//Writes since the last callback
+	//Work for the thread, only touched by the emulation when the thread is idle
+	struct {
+		std::vector<RegWrite> writes;
+		double start, end;
+		Bitu samples;
+		std::vector<Bit32s> output;	//Always stereo
+	} job;
+	bool busy;
+	double lastTime;
+	//Samples the thread has finished, the first part is the latency
+	std::vector<Bit32s> fifo;
+	Bitu fifoUsed;
+	Bitu latency;
+	Bitu rate;
+
+	SDL_Thread * thread;
+	SDL_sem * todo;
+	SDL_sem * done;
+	volatile bool quit;
+
+	virtual Bit32u WriteAddr( Bit32u port, Bit8u val ) {
+		//Same as DBOPL::Chip::WriteAddr, but can't look at the chip while the thread is running
+		switch ( port & 3 ) {
+		case 0:
+			return val;
+		case 2:
+			if ( opl3Active || (val == 0x05) )
+				return 0x100 | val;
+			else 
+				return val;
+		}
+		return 0;
+	}
+	virtual void WriteReg( Bit32u addr, Bit8u val ) {
+		if ( addr == 0x105 )
+			opl3Active = ( val & 1 ) ? 0xff : 0;
+		RegWrite write;
+		write.time = PIC_FullIndex();
+		write.addr = addr;
+		write.val = val;
+		pending.push_back( write );
+	}
+	void Render( Bitu samples, Bit32s* output ) {
+		Bit32s buffer[ 512 * 2 ];
+		while ( samples > 0 ) {
+			Bitu todo = samples > 512 ? 512 : samples;
+			samples -= todo;
+			if ( !opl.chip.opl3Active ) {
+				opl.chip.GenerateBlock2( todo, buffer );
+				for ( Bitu i = 0; i < todo; i++ )
+					output[i*2+0] = output[i*2+1] = buffer[i];
+			} else {
+				opl.chip.GenerateBlock3( todo, output );
+			}
+			output += todo * 2;
+		}
+	}
+	void RunJob( void ) {
+		Bitu pos = 0;
+		double length = job.end - job.start;
+		for ( Bitu i = 0; i < job.writes.size(); i++ ) {
+			const RegWrite& write = job.writes[i];
+			//Sample where the write took place
+			Bitu target = 0;
+			if ( length > 0 && write.time > job.start ) {
+				target = (Bitu)( ( write.time - job.start ) / length * job.samples );
+				if ( target > job.samples )
+					target = job.samples;
+			}
+			if ( target > pos ) {
+				Render( target - pos, &job.output[pos * 2] );
+				pos = target;
+			}
+			opl.WriteReg( write.addr, write.val );
+		}
+		if ( job.samples > pos )
+			Render( job.samples - pos, &job.output[pos * 2] );
+	}
+	static int ThreadProc( void* data ) {
+		Handler* handler = (Handler*)data;
+		for (;;) {
+			SDL_SemWait( handler->todo );
+			if ( handler->quit )
+				break;
+			handler->RunJob();
+			SDL_SemPost( handler->done );
+		}
+		return 0;
+	}
+	void Finish( void ) {
+		if ( !busy )
+			return;
+		SDL_SemWait( done );
+		busy = false;
+		Bitu size = job.samples * 2;
+		if ( !size )
+			return;
+		if ( fifo.size() < (fifoUsed * 2 + size) )
+			fifo.resize( fifoUsed * 2 + size );
+		memcpy( &fifo[fifoUsed * 2], &job.output[0], size * sizeof(Bit32s) );
+		fifoUsed += job.samples;
+	}
+	virtual void Generate( MixerChannel* chan, Bitu samples ) {
+		double now = PIC_FullIndex();
+		Finish();
+		//Start on this period
+		job.writes.swap( pending );
+		pending.clear();
+		//After the channel was disabled the period since the last callback is too long
+		job.start = now - samples * 1000.0 / rate;
+		if ( job.start < lastTime )
+			job.start = lastTime;
+		job.end = now;
+		job.samples = samples;
+		if ( job.output.size() < samples * 2 )
+			job.output.resize( samples * 2 );
+		lastTime = now;
+		busy = true;
+		SDL_SemPost( todo );
+		//Hand out the samples of the previous periods
+		if ( fifoUsed < samples ) {
+			//Larger request than usual, pad with silence to keep the timing
+			Bitu pad = samples - fifoUsed;
+			fifo.resize( samples * 2 );
+			memmove( &fifo[pad * 2], &fifo[0], fifoUsed * 2 * sizeof(Bit32s) );
+			memset( &fifo[0], 0, pad * 2 * sizeof(Bit32s) );
+			fifoUsed = samples;
+		}
+		chan->AddSamples_s32( samples, &fifo[0] );
+		fifoUsed -= samples;
+		//Don't let the latency grow after a large request
+		Bitu skip = fifoUsed > latency * 2 ? fifoUsed - latency : 0;
+		memmove( &fifo[0], &fifo[(samples + skip) * 2], (fifoUsed - skip) * 2 * sizeof(Bit32s) );
+		fifoUsed -= skip;
+	}
+	virtual void Init( Bitu rate ) {
+		this->rate = rate;
+		opl.Init( rate );
+		opl3Active = 0;
+		busy = false;
+		quit = false;
+		lastTime = PIC_FullIndex();
+		//Start with a tick of silence, the thread stays that far behind
+		latency = rate / 1000 + 1;
+		fifo.assign( latency * 2, 0 );
+		fifoUsed = latency;
+		todo = SDL_CreateSemaphore( 0 );
+		done = SDL_CreateSemaphore( 0 );
+		thread = SDL_CreateThread( &ThreadProc, this );
+		if ( !thread )
+			E_Exit( "OPL: Can't start the synthesis thread" );
+	}
+	~Handler() {
+		Finish();
+		quit = true;
+		SDL_SemPost( todo );
+		SDL_WaitThread( thread, 0 );
+		SDL_DestroySemaphore( todo );
+		SDL_DestroySemaphore( done );
+	}
+};
+
+}
 
 #define RAW_SIZE 1024
 
@@ -784,13 +967,16 @@ Module::Module( Section* configuration ) : Module_base(configuration) {
 	if ( rate < 8000 )
 		rate = 8000;
 	std::string oplemu( section->Get_string( "oplemu" ) );
+	bool threaded = section->Get_bool( "oplthread" );
 	ctrl.mixer = section->Get_bool("sbmixer");
 
 	mixerChan = mixerObject.Install(OPL_CallBack,rate,"FM");
 	//Used to be 2.0, which was measured to be too high. Exact value depends on card/clone.
 	mixerChan->SetScale( 1.5f );  
 
-	if (oplemu == "fast") {
+	if (threaded && (oplemu == "fast" || oplemu == "default")) {
+		handler = new DBOPLThreaded::Handler();
+	} else if (oplemu == "fast") {
 		handler = new DBOPL::Handler();
 	} else if (oplemu == "compat") {
 		if ( oplmode == OPL_opl2 ) {
@@ -41,6 +41,20 @@ static void UpdateEMSMapping(void) {
 	}
 }
 
+/* translate a (doubled for 16bit dma) offset into a physical address, the run
+   is cut down to the end of the page; wrap masks are multiples of the page size
+   minus one, so that is where the offset can wrap as well */
+static INLINE PhysPt DMA_TranslateRun(Bitu highpart_addr_page,PhysPt offset,Bitu & run) {
+	Bitu page = highpart_addr_page+(offset >> 12);
+	/* care for EMS pageframe etc. */
+	if (page < EMM_PAGEFRAME4K) page = paging.firstmb[page];
+	else if (page < EMM_PAGEFRAME4K+0x10) page = ems_board_mapping[page];
+	else if (page < LINK_START) page = paging.firstmb[page];
+	Bitu left = 4096 - (offset & 4095);
+	if (run > left) run = left;
+	return page*4096 + (offset & 4095);
+}
+
 /* read a block from physical memory */
 static void DMA_BlockRead(PhysPt spage,PhysPt offset,void * data,Bitu size,Bit8u dma16) {
 	Bit8u * write=(Bit8u *) data;
@@ -48,17 +62,18 @@ static void DMA_BlockRead(PhysPt spage,PhysPt offset,void * data,Bitu size,Bit8u
 	size <<= dma16;
 	offset <<= dma16;
 	Bit32u dma_wrap = ((0xffff<<dma16)+dma16) | dma_wrapping;
-	for ( ; size ; size--, offset++) {
-		if (offset>(dma_wrapping<<dma16)) {
+	while (size) {
+		bool wrapped = offset>(dma_wrapping<<dma16);
+		offset &= dma_wrap;
+		Bitu run = size;
+		PhysPt addr = DMA_TranslateRun(highpart_addr_page,offset,run);
+		if (wrapped || (offset+run-1>(dma_wrapping<<dma16))) {
 			LOG_MSG("DMA segbound wrapping (read): %x:%x size %x [%x] wrap %x",spage,offset,size,dma16,dma_wrapping);
 		}
-		offset &= dma_wrap;
-		Bitu page = highpart_addr_page+(offset >> 12);
-		/* care for EMS pageframe etc. */
-		if (page < EMM_PAGEFRAME4K) page = paging.firstmb[page];
-		else if (page < EMM_PAGEFRAME4K+0x10) page = ems_board_mapping[page];
-		else if (page < LINK_START) page = paging.firstmb[page];
-		*write++=phys_readb(page*4096 + (offset & 4095));
+		memcpy(write,MemBase+addr,run);
+		write += run;
+		offset += run;
+		size -= run;
 	}
 }
 
@@ -69,17 +84,18 @@ static void DMA_BlockWrite(PhysPt spage,PhysPt offset,void * data,Bitu size,Bit8
 	size <<= dma16;
 	offset <<= dma16;
 	Bit32u dma_wrap = ((0xffff<<dma16)+dma16) | dma_wrapping;
-	for ( ; size ; size--, offset++) {
-		if (offset>(dma_wrapping<<dma16)) {
+	while (size) {
+		bool wrapped = offset>(dma_wrapping<<dma16);
+		offset &= dma_wrap;
+		Bitu run = size;
+		PhysPt addr = DMA_TranslateRun(highpart_addr_page,offset,run);
+		if (wrapped || (offset+run-1>(dma_wrapping<<dma16))) {
 			LOG_MSG("DMA segbound wrapping (write): %x:%x size %x [%x] wrap %x",spage,offset,size,dma16,dma_wrapping);
 		}
-		offset &= dma_wrap;
-		Bitu page = highpart_addr_page+(offset >> 12);
-		/* care for EMS pageframe etc. */
-		if (page < EMM_PAGEFRAME4K) page = paging.firstmb[page];
-		else if (page < EMM_PAGEFRAME4K+0x10) page = ems_board_mapping[page];
-		else if (page < LINK_START) page = paging.firstmb[page];
-		phys_writeb(page*4096 + (offset & 4095), *read++);
+		memcpy(MemBase+addr,read,run);
+		read += run;
+		offset += run;
+		size -= run;
 	}
 }
 
@@ -32,6 +32,10 @@
 
 #if (C_SSHOT)
 #include <png.h>
+#include "SDL.h"
+#include "SDL_thread.h"
+#include "timer.h"
+#define ZMBV_SEARCH_THREADS 4
 #include "../libs/zmbv/zmbv.cpp"
 #endif
 
@@ -42,6 +46,20 @@ Bitu CaptureState;
 #define WAVE_BUF 16*1024
 #define MIDI_BUF 4*1024
 #define AVI_HEADER_SIZE	500
+#define VIDEO_FRAMES 8
+
+#if (C_SSHOT)
+/* Frame waiting for the video encoder thread, with the audio that goes with it */
+typedef struct {
+	Bit8u		*data;
+	Bitu		dataSize;
+	Bitu		width, height, pitch, flags;
+	Bit8u		pal[256*4];
+	Bit16s		audio[WAVE_BUF][2];
+	Bitu		audioused;
+	bool		stop;
+} CaptureFrame_t;
+#endif
 
 static struct {
 	struct {
@@ -76,6 +94,17 @@ static struct {
 		void		*buf;
 		Bit8u		*index;
 		Bitu		indexsize, indexused;
+		zmbv_format_t format;
+		/* The compression and writing is done by a separate thread */
+		struct {
+			SDL_Thread		*thread;
+			SDL_sem			*filled, *empty;
+			CaptureFrame_t	frames[VIDEO_FRAMES];
+			Bitu			read, write;
+			volatile bool	failed;
+			Bitu			queued, stalls;
+			Bit32u			stallTicks;
+		} queue;
 	} video;
 #endif
 } capture;
@@ -157,6 +186,137 @@ static void CAPTURE_AddAviChunk(const char * tag, Bit32u size, void * data, Bit3
 	host_writed(index+8, pos);
 	host_writed(index+12, size);
 }
+
+static void CAPTURE_VideoEncode(CaptureFrame_t * frame) {
+	Bit8u doubleRow[SCALER_MAXWIDTH*4];
+	Bitu width = frame->width, height = frame->height, pitch = frame->pitch, flags = frame->flags;
+	Bitu bpp = capture.video.bpp;
+	Bit8u * data = frame->data;
+	int codecFlags;
+	if (capture.video.frames % 300 == 0)
+		codecFlags = 1;
+	else codecFlags = 0;
+	if (!capture.video.codec->PrepareCompressFrame( codecFlags, capture.video.format, (char *)frame->pal, capture.video.buf, capture.video.bufSize)) {
+		capture.video.queue.failed = true;
+		return;
+	}
+
+	for (Bitu i=0;i<height;i++) {
+		void * rowPointer;
+		if (flags & CAPTURE_FLAG_DBLW) {
+			void *srcLine;
+			Bitu x;
+			Bitu countWidth = width >> 1;
+			if (flags & CAPTURE_FLAG_DBLH)
+				srcLine=(data+(i >> 1)*pitch);
+			else
+				srcLine=(data+(i >> 0)*pitch);
+			switch ( bpp) {
+			case 8:
+				for (x=0;x<countWidth;x++)
+					((Bit8u *)doubleRow)[x*2+0] =
+					((Bit8u *)doubleRow)[x*2+1] = ((Bit8u *)srcLine)[x];
+				break;
+			case 15:
+			case 16:
+				for (x=0;x<countWidth;x++)
+					((Bit16u *)doubleRow)[x*2+0] =
+					((Bit16u *)doubleRow)[x*2+1] = ((Bit16u *)srcLine)[x];
+				break;
+			case 32:
+				for (x=0;x<countWidth;x++)
+					((Bit32u *)doubleRow)[x*2+0] =
+					((Bit32u *)doubleRow)[x*2+1] = ((Bit32u *)srcLine)[x];
+				break;
+			}
+			rowPointer=doubleRow;
+		} else {
+			if (flags & CAPTURE_FLAG_DBLH)
+				rowPointer=(data+(i >> 1)*pitch);
+			else
+				rowPointer=(data+(i >> 0)*pitch);
+		}
+		capture.video.codec->CompressLines( 1, &rowPointer );
+	}
+	int written = capture.video.codec->FinishCompressFrame();
+	if (written < 0) {
+		capture.video.queue.failed = true;
+		return;
+	}
+	CAPTURE_AddAviChunk( "00dc", written, capture.video.buf, codecFlags & 1 ? 0x10 : 0x0);
+	capture.video.frames++;
+//	LOG_MSG("Frame %d video %d audio %d",capture.video.frames, written, frame->audioused *4 );
+	if ( frame->audioused ) {
+		CAPTURE_AddAviChunk( "01wb", frame->audioused * 4, frame->audio, 0);
+		capture.video.audiowritten = frame->audioused*4;
+	}
+}
+
+static int CAPTURE_VideoThread(void * /*data*/) {
+	for (;;) {
+		SDL_SemWait(capture.video.queue.filled);
+		CaptureFrame_t * frame = &capture.video.queue.frames[capture.video.queue.read];
+		capture.video.queue.read = (capture.video.queue.read + 1) % VIDEO_FRAMES;
+		if (frame->stop)
+			break;
+		if (!capture.video.queue.failed)
+			CAPTURE_VideoEncode(frame);
+		SDL_SemPost(capture.video.queue.empty);
+	}
+	return 0;
+}
+
+static bool CAPTURE_VideoStartThread(void) {
+	capture.video.queue.read = capture.video.queue.write = 0;
+	capture.video.queue.failed = false;
+	capture.video.queue.queued = 0;
+	capture.video.queue.stalls = 0;
+	capture.video.queue.stallTicks = 0;
+	capture.video.queue.filled = SDL_CreateSemaphore(0);
+	capture.video.queue.empty = SDL_CreateSemaphore(VIDEO_FRAMES);
+	capture.video.queue.thread = SDL_CreateThread(&CAPTURE_VideoThread,0);
+	if (!capture.video.queue.thread) {
+		LOG_MSG("Can't start the video encoder thread");
+		SDL_DestroySemaphore(capture.video.queue.filled);
+		SDL_DestroySemaphore(capture.video.queue.empty);
+		return false;
+	}
+	return true;
+}
+
+/* Returns a free frame, waits for the encoder when all of them are in use */
+static CaptureFrame_t * CAPTURE_VideoGetFrame(void) {
+	if (SDL_SemTryWait(capture.video.queue.empty)) {
+		Bit32u start = GetTicks();
+		SDL_SemWait(capture.video.queue.empty);
+		capture.video.queue.stalls++;
+		capture.video.queue.stallTicks += GetTicks() - start;
+	}
+	CaptureFrame_t * frame = &capture.video.queue.frames[capture.video.queue.write];
+	capture.video.queue.write = (capture.video.queue.write + 1) % VIDEO_FRAMES;
+	return frame;
+}
+
+/* Lets the encoder finish all queued frames */
+static void CAPTURE_VideoStopThread(void) {
+	if (!capture.video.queue.thread)
+		return;
+	CaptureFrame_t * frame = CAPTURE_VideoGetFrame();
+	frame->stop = true;
+	SDL_SemPost(capture.video.queue.filled);
+	SDL_WaitThread(capture.video.queue.thread, 0);
+	capture.video.queue.thread = 0;
+	SDL_DestroySemaphore(capture.video.queue.filled);
+	SDL_DestroySemaphore(capture.video.queue.empty);
+	for (Bitu i=0;i<VIDEO_FRAMES;i++) {
+		free(capture.video.queue.frames[i].data);
+		capture.video.queue.frames[i].data = 0;
+		capture.video.queue.frames[i].dataSize = 0;
+	}
+	if (capture.video.queue.stalls)
+		LOG_MSG("Video capture had to wait %d times for the encoder (%d ms in total) for %d frames",
+			capture.video.queue.stalls, capture.video.queue.stallTicks, capture.video.queue.queued);
+}
 #endif
 
 #if (C_SSHOT)
@@ -174,6 +334,9 @@ static void CAPTURE_VideoEvent(bool pressed) {
 #define AVIOUT4(_S_) memcpy(&avi_header[header_pos],_S_,4);header_pos+=4;
 #define AVIOUTw(_S_) host_writew(&avi_header[header_pos], _S_);header_pos+=2;
 #define AVIOUTd(_S_) host_writed(&avi_header[header_pos], _S_);header_pos+=4;
+		CAPTURE_VideoStopThread();
+		if (capture.video.queue.failed)
+			LOG_MSG("Video encoding failed, the capture is incomplete");
 		/* Try and write an avi header */
 		AVIOUT4("RIFF");                    // Riff header 
 		AVIOUTd(AVI_HEADER_SIZE + capture.video.written - 8 + capture.video.indexused);
@@ -463,7 +626,8 @@ skip_shot:
 			capture.video.width != width ||
 			capture.video.height != height ||
 			capture.video.bpp != bpp ||
-			capture.video.fps != fps)) 
+			capture.video.fps != fps ||
+			capture.video.queue.failed)) 
 		{
 			CAPTURE_VideoEvent(true);
 		}
@@ -505,62 +669,35 @@ skip_shot:
 			capture.video.written = 0;
 			capture.video.audioused = 0;
 			capture.video.audiowritten = 0;
+			capture.video.format = format;
+			if (!CAPTURE_VideoStartThread())
+				goto skip_video;
 		}
-		int codecFlags;
-		if (capture.video.frames % 300 == 0)
-			codecFlags = 1;
-		else codecFlags = 0;
-		if (!capture.video.codec->PrepareCompressFrame( codecFlags, format, (char *)pal, capture.video.buf, capture.video.bufSize))
-			goto skip_video;
-
-		for (i=0;i<height;i++) {
-			void * rowPointer;
-			if (flags & CAPTURE_FLAG_DBLW) {
-				void *srcLine;
-				Bitu x;
-				Bitu countWidth = width >> 1;
-				if (flags & CAPTURE_FLAG_DBLH)
-					srcLine=(data+(i >> 1)*pitch);
-				else
-					srcLine=(data+(i >> 0)*pitch);
-				switch ( bpp) {
-				case 8:
-					for (x=0;x<countWidth;x++)
-						((Bit8u *)doubleRow)[x*2+0] =
-						((Bit8u *)doubleRow)[x*2+1] = ((Bit8u *)srcLine)[x];
-					break;
-				case 15:
-				case 16:
-					for (x=0;x<countWidth;x++)
-						((Bit16u *)doubleRow)[x*2+0] =
-						((Bit16u *)doubleRow)[x*2+1] = ((Bit16u *)srcLine)[x];
-					break;
-				case 32:
-					for (x=0;x<countWidth;x++)
-						((Bit32u *)doubleRow)[x*2+0] =
-						((Bit32u *)doubleRow)[x*2+1] = ((Bit32u *)srcLine)[x];
-					break;
-				}
-                rowPointer=doubleRow;
-			} else {
-				if (flags & CAPTURE_FLAG_DBLH)
-					rowPointer=(data+(i >> 1)*pitch);
-				else
-					rowPointer=(data+(i >> 0)*pitch);
-			}
-			capture.video.codec->CompressLines( 1, &rowPointer );
-		}
-		int written = capture.video.codec->FinishCompressFrame();
-		if (written < 0)
+		if (!capture.video.queue.thread)
 			goto skip_video;
-		CAPTURE_AddAviChunk( "00dc", written, capture.video.buf, codecFlags & 1 ? 0x10 : 0x0);
-		capture.video.frames++;
-//		LOG_MSG("Frame %d video %d audio %d",capture.video.frames, written, capture.video.audioused *4 );
-		if ( capture.video.audioused ) {
-			CAPTURE_AddAviChunk( "01wb", capture.video.audioused * 4, capture.video.audiobuf, 0);
-			capture.video.audiowritten = capture.video.audioused*4;
-			capture.video.audioused = 0;
+		/* Only copy the frame here, the encoder thread does the rest */
+		CaptureFrame_t * frame = CAPTURE_VideoGetFrame();
+		Bitu size = (flags & CAPTURE_FLAG_DBLH ? height >> 1 : height) * pitch;
+		if (frame->dataSize < size) {
+			free(frame->data);
+			frame->data = (Bit8u*)malloc(size);
+			if (!frame->data)
+				E_Exit("Ran out of memory during AVI capturing");
+			frame->dataSize = size;
 		}
+		memcpy(frame->data, data, size);
+		if (bpp == 8)
+			memcpy(frame->pal, pal, sizeof(frame->pal));
+		frame->width = width;
+		frame->height = height;
+		frame->pitch = pitch;
+		frame->flags = flags;
+		frame->stop = false;
+		frame->audioused = capture.video.audioused;
+		memcpy(frame->audio, capture.video.audiobuf, capture.video.audioused*4);
+		capture.video.audioused = 0;
+		capture.video.queue.queued++;
+		SDL_SemPost(capture.video.queue.filled);
 
 		/* Everything went okay, set flag again for next frame */
 		CaptureState |= CAPTURE_VIDEO;
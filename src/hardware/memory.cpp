@@ -173,21 +173,68 @@ void mem_strcpy(PhysPt dest,PhysPt src) {
 	mem_writeb_inline(dest,0);
 }
 
+/* The block functions below work in chunks that don't cross a page boundary,
+   pages with host memory on both sides are copied as a whole while pages
+   behind a handler (not linked yet, vga, rom, pages with dynamic code)
+   are done byte by byte; the handler may link the page on the way. */
+static INLINE Bitu mem_pagechunk(PhysPt pt,Bitu size) {
+	Bitu left=MEM_PAGE_SIZE-(pt&(MEM_PAGE_SIZE-1));
+	return (left<size) ? left : size;
+}
+
 void mem_memcpy(PhysPt dest,PhysPt src,Bitu size) {
-	while (size--) mem_writeb_inline(dest++,mem_readb_inline(src++));
+	while (size) {
+		Bitu chunk=mem_pagechunk(src,mem_pagechunk(dest,size));
+		HostPt tlb_src=get_tlb_read(src);
+		HostPt tlb_dest=get_tlb_write(dest);
+		if (tlb_src && tlb_dest) {
+			HostPt hsrc=tlb_src+src;
+			HostPt hdest=tlb_dest+dest;
+			if ((hdest>hsrc) && (hdest<hsrc+chunk)) {
+				// forward overlap, replicate like the bytewise copy does
+				for (Bitu i=0;i<chunk;i++) hdest[i]=hsrc[i];
+			} else memmove(hdest,hsrc,chunk);
+			src+=chunk;
+			dest+=chunk;
+			size-=chunk;
+		} else {
+			mem_writeb_inline(dest++,mem_readb_inline(src++));
+			size--;
+		}
+	}
 }
 
 void MEM_BlockRead(PhysPt pt,void * data,Bitu size) {
 	Bit8u * write=reinterpret_cast<Bit8u *>(data);
-	while (size--) {
-		*write++=mem_readb_inline(pt++);
+	while (size) {
+		Bitu chunk=mem_pagechunk(pt,size);
+		HostPt tlb_addr=get_tlb_read(pt);
+		if (tlb_addr) {
+			memcpy(write,tlb_addr+pt,chunk);
+			write+=chunk;
+			pt+=chunk;
+			size-=chunk;
+		} else {
+			*write++=mem_readb_inline(pt++);
+			size--;
+		}
 	}
 }
 
 void MEM_BlockWrite(PhysPt pt,void const * const data,Bitu size) {
 	Bit8u const * read = reinterpret_cast<Bit8u const * const>(data);
-	while (size--) {
-		mem_writeb_inline(pt++,*read++);
+	while (size) {
+		Bitu chunk=mem_pagechunk(pt,size);
+		HostPt tlb_addr=get_tlb_write(pt);
+		if (tlb_addr) {
+			memcpy(tlb_addr+pt,read,chunk);
+			read+=chunk;
+			pt+=chunk;
+			size-=chunk;
+		} else {
+			mem_writeb_inline(pt++,*read++);
+			size--;
+		}
 	}
 }
 
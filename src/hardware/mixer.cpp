@@ -25,6 +25,10 @@
 #include <string.h>
 #include <sys/types.h>
 #include <math.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIXER_SSE2 1
+#include <emmintrin.h>
+#endif
 
 #if defined (WIN32)
 //Midi listing
@@ -60,10 +64,24 @@
 #define FREQ_NEXT ( 1 << FREQ_SHIFT)
 #define FREQ_MASK ( FREQ_NEXT -1 )
 
+/* Phases of the band-limited resampler, picked from the upper bits of the frequency counter */
+#define SINC_PHASESHIFT 8
+#define SINC_PHASES (1 << SINC_PHASESHIFT)
+#define SINC_SHIFT 14
+
 #define TICK_SHIFT 14
 #define TICK_NEXT ( 1 << TICK_SHIFT)
 #define TICK_MASK (TICK_NEXT -1)
 
+/* The ring between the emulation and the audio callback only needs ordering between the
+ * data and the index that publishes it, so a full barrier around the index updates */
+#if defined(__GNUC__)
+#define MIXER_BARRIER() __sync_synchronize()
+#elif defined(_MSC_VER)
+#define MIXER_BARRIER() MemoryBarrier()
+#else
+#define MIXER_BARRIER()
+#endif
 
 static INLINE Bit16s MIXER_CLIP(Bits SAMP) {
 	if (SAMP < MAX_AUDIO) {
@@ -84,8 +102,20 @@ static struct {
 	float mastervol[2];
 	MixerChannel * channels;
 	bool nosound;
+	bool sinc;
 	Bit32u freq;
 	Bit32u blocksize;
+	//Finished samples, written by the emulation and read by the audio callback
+	struct {
+		Bit16s data[MIXER_BUFSIZE][2];
+		volatile Bitu write;
+		volatile Bitu read;
+	} ring;
+	struct {
+		volatile Bitu underruns, overruns;
+		volatile Bitu latency, maxLatency;		//In samples
+		volatile Bitu latencyTotal, callbacks;
+	} stats;
 } mixer;
 
 Bit8u MixTemp[MIXER_BUFSIZE];
@@ -95,6 +125,10 @@ MixerChannel * MIXER_AddChannel(MIXER_Handler handler,Bitu freq,const char * nam
 	chan->scale = 1.0;
 	chan->handler=handler;
 	chan->name=name;
+	chan->sincTable=0;
+	chan->sincCutoff=0;
+	chan->historyPos=0;
+	memset(chan->history,0,sizeof(chan->history));
 	chan->SetFreq(freq);
 	chan->next=mixer.channels;
 	chan->SetVolume(1,1);
@@ -119,6 +153,7 @@ void MIXER_DelChannel(MixerChannel* delchan) {
 	while (chan) {
 		if (chan==delchan) {
 			*where=chan->next;
+			delete[] delchan->sincTable;
 			delete delchan;
 			return;
 		}
@@ -148,9 +183,30 @@ void MixerChannel::Enable(bool _yesno) {
 	enabled=_yesno;
 	if (enabled) {
 		freq_counter = 0;
-		SDL_LockAudio();
 		if (done<mixer.done) done=mixer.done;
-		SDL_UnlockAudio();
+	}
+}
+
+/* Windowed sinc table, for every phase the taps around the point between the
+ * 2 middle samples of the window. Cutoff is relative to the input rate. */
+static void MIXER_MakeSincTable(Bit32s * table,double cutoff) {
+	const double pi = 3.14159265358979323846;
+	for (Bitu p=0;p<SINC_PHASES;p++) {
+		double frac = (double)p / SINC_PHASES;
+		double coef[MIXER_SINC_TAPS];
+		double total = 0;
+		for (Bitu k=0;k<MIXER_SINC_TAPS;k++) {
+			double x = (double)k - (MIXER_SINC_TAPS/2 - 1) - frac;
+			double s = x == 0 ? 1.0 : sin(pi * cutoff * x) / (pi * cutoff * x);
+			//Blackman window over the length of the taps
+			double w = (x + MIXER_SINC_TAPS/2) / MIXER_SINC_TAPS;
+			double window = w <= 0 || w >= 1 ? 0 : 0.42 - 0.5 * cos(2 * pi * w) + 0.08 * cos(4 * pi * w);
+			coef[k] = s * window;
+			total += coef[k];
+		}
+		//Normalize so every phase passes DC unchanged
+		for (Bitu k=0;k<MIXER_SINC_TAPS;k++)
+			table[p*MIXER_SINC_TAPS+k] = (Bit32s)floor(coef[k] / total * (1 << SINC_SHIFT) + 0.5);
 	}
 }
 
@@ -163,6 +219,17 @@ void MixerChannel::SetFreq(Bitu freq) {
 	else {
 		interpolate = false;
 	}
+	if (interpolate && mixer.sinc) {
+		//Keep a little room below nyquist of the lower of both rates
+		double cutoff = 0.9;
+		if (freq > mixer.freq) cutoff *= (double)mixer.freq / freq;
+		//Devices like the sound blaster set the rate again for every dma transfer
+		if (!sincTable || cutoff != sincCutoff) {
+			if (!sincTable) sincTable = new Bit32s[SINC_PHASES*MIXER_SINC_TAPS];
+			MIXER_MakeSincTable(sincTable,cutoff);
+			sincCutoff = cutoff;
+		}
+	}
 }
 
 void MixerChannel::Mix(Bitu _needed) {
@@ -186,8 +253,124 @@ void MixerChannel::AddSilence(void) {
 	}
 }
 
+template<class Type,bool signeddata>
+static INLINE Bits MIXER_ConvertSample(Type sample) {
+	if (sizeof(Type) == 1) {
+		if (!signeddata) return ((Bit8s)(sample ^ 0x80)) << 8;
+		return ((Bit8s)sample) << 8;
+	}
+	if (!signeddata) return (Bits)sample - 32768;
+	return (Bits)sample;
+}
+
+#if MIXER_SSE2
+/* Low 32 bits of a 32x32 multiply, SSE2 only has the unsigned 32x32->64 one */
+static INLINE __m128i MIXER_Mul32(__m128i a,__m128i b) {
+	__m128i even = _mm_mul_epu32(a,b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a,32),_mm_srli_epi64(b,32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even,_MM_SHUFFLE(0,0,2,0)),_mm_shuffle_epi32(odd,_MM_SHUFFLE(0,0,2,0)));
+}
+
+/* Add 4 stereo pairs of 32 bit samples */
+static INLINE void MIXER_Add4(Bit32s * write,__m128i left,__m128i right,__m128i vol) {
+	__m128i * dst = (__m128i *)write;
+	_mm_storeu_si128(dst,_mm_add_epi32(_mm_loadu_si128(dst),MIXER_Mul32(_mm_unpacklo_epi32(left,right),vol)));
+	_mm_storeu_si128(dst+1,_mm_add_epi32(_mm_loadu_si128(dst+1),MIXER_Mul32(_mm_unpackhi_epi32(left,right),vol)));
+}
+#endif
+
+/* Accumulate samples that need no rate conversion, count is in sample frames */
+template<class Type,bool stereo,bool signeddata>
+static void MIXER_AddBlock(Bit32s * write,const Type * data,Bitu count,const Bit32s * volmul) {
+	Bitu i = 0;
+#if MIXER_SSE2
+	const __m128i vol = _mm_setr_epi32(volmul[0],volmul[1],volmul[0],volmul[1]);
+	const __m128i zero = _mm_setzero_si128();
+	if (sizeof(Type) == 2 && signeddata) {
+		//16 bit samples get sign extended to 32 bit
+		if (stereo) {
+			for (;i+4<=count;i+=4) {
+				__m128i in = _mm_loadu_si128((const __m128i *)&data[i*2]);
+				__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in,in),16);
+				__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in,in),16);
+				__m128i * dst = (__m128i *)&write[i*2];
+				_mm_storeu_si128(dst,_mm_add_epi32(_mm_loadu_si128(dst),MIXER_Mul32(lo,vol)));
+				_mm_storeu_si128(dst+1,_mm_add_epi32(_mm_loadu_si128(dst+1),MIXER_Mul32(hi,vol)));
+			}
+		} else {
+			for (;i+4<=count;i+=4) {
+				__m128i in = _mm_loadl_epi64((const __m128i *)&data[i]);
+				__m128i s = _mm_srai_epi32(_mm_unpacklo_epi16(in,in),16);
+				MIXER_Add4(&write[i*2],s,s,vol);
+			}
+		}
+	} else if (sizeof(Type) == 1) {
+		//8 bit samples end up in the upper byte of 16 bit ones
+		const __m128i flip = _mm_set1_epi8(signeddata ? 0 : (char)0x80);
+		if (stereo) {
+			for (;i+4<=count;i+=4) {
+				Bit32u bytes[2];
+				memcpy(bytes,&data[i*2],8);
+				__m128i in = _mm_xor_si128(_mm_loadl_epi64((const __m128i *)bytes),flip);
+				__m128i words = _mm_unpacklo_epi8(zero,in);
+				__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(words,words),16);
+				__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(words,words),16);
+				__m128i * dst = (__m128i *)&write[i*2];
+				_mm_storeu_si128(dst,_mm_add_epi32(_mm_loadu_si128(dst),MIXER_Mul32(lo,vol)));
+				_mm_storeu_si128(dst+1,_mm_add_epi32(_mm_loadu_si128(dst+1),MIXER_Mul32(hi,vol)));
+			}
+		} else {
+			for (;i+4<=count;i+=4) {
+				Bit32u bytes;
+				memcpy(&bytes,&data[i],4);
+				__m128i in = _mm_xor_si128(_mm_cvtsi32_si128(bytes),flip);
+				__m128i words = _mm_unpacklo_epi8(zero,in);
+				__m128i s = _mm_srai_epi32(_mm_unpacklo_epi16(words,words),16);
+				MIXER_Add4(&write[i*2],s,s,vol);
+			}
+		}
+	}
+#endif
+	for (;i<count;i++) {
+		Bits sample = MIXER_ConvertSample<Type,signeddata>(data[stereo ? i*2 : i]);
+		write[i*2+0] += sample * volmul[0];
+		if (stereo) sample = MIXER_ConvertSample<Type,signeddata>(data[i*2+1]);
+		write[i*2+1] += sample * volmul[1];
+	}
+}
+
 template<class Type,bool stereo,bool signeddata,bool nativeorder>
 inline void MixerChannel::AddSamples(Bitu len, const Type* data) {
+	/* Same rate and a plain format: every output sample is the previous input sample */
+	if (!interpolate && nativeorder && sizeof(Type) < 4 && len &&
+		freq_add == FREQ_NEXT && freq_counter >= FREQ_NEXT && freq_counter < 2*FREQ_NEXT) {
+		Bitu mixpos = (mixer.pos + done) & MIXER_BUFMASK;
+		//The sample that was read ahead goes first
+		mixer.work[mixpos][0] += nextSample[0] * volmul[0];
+		mixer.work[mixpos][1] += (stereo ? nextSample[1] : nextSample[0]) * volmul[1];
+		prevSample[0] = nextSample[0];
+		if (stereo) prevSample[1] = nextSample[1];
+		mixpos = (mixpos + 1) & MIXER_BUFMASK;
+		Bitu left = len - 1;
+		const Type * src = data;
+		while (left) {
+			//Split at the end of the work buffer
+			Bitu count = MIXER_BUFSIZE - mixpos;
+			if (count > left) count = left;
+			MIXER_AddBlock<Type,stereo,signeddata>(mixer.work[mixpos],src,count,volmul);
+			src += stereo ? count*2 : count;
+			mixpos = (mixpos + count) & MIXER_BUFMASK;
+			left -= count;
+		}
+		if (len >= 2) {
+			prevSample[0] = MIXER_ConvertSample<Type,signeddata>(data[stereo ? (len-2)*2 : len-2]);
+			if (stereo) prevSample[1] = MIXER_ConvertSample<Type,signeddata>(data[(len-2)*2+1]);
+		}
+		nextSample[0] = MIXER_ConvertSample<Type,signeddata>(data[stereo ? (len-1)*2 : len-1]);
+		if (stereo) nextSample[1] = MIXER_ConvertSample<Type,signeddata>(data[(len-1)*2+1]);
+		done += len;
+		return;
+	}
 	//Position where to write the data
 	Bitu mixpos = mixer.pos + done;
 	//Position in the incoming data
@@ -274,6 +457,11 @@ inline void MixerChannel::AddSamples(Bitu len, const Type* data) {
 					}
 				}
 			}
+			if (sincTable) {
+				history[historyPos][0] = history[historyPos+MIXER_SINC_TAPS][0] = nextSample[0];
+				history[historyPos][1] = history[historyPos+MIXER_SINC_TAPS][1] = stereo ? nextSample[1] : nextSample[0];
+				historyPos = (historyPos + 1) & (MIXER_SINC_TAPS - 1);
+			}
 			//This sample has been handled now, increase position
 			pos++;
 		}
@@ -283,8 +471,18 @@ inline void MixerChannel::AddSamples(Bitu len, const Type* data) {
 		if (!interpolate) {
 			write[0] += prevSample[0] * volmul[0];
 			write[1] += (stereo ? prevSample[1] : prevSample[0]) * volmul[1];
-		}
-		else {
+		} else if (sincTable) {
+			const Bit32s * coef = &sincTable[((freq_counter & FREQ_MASK) >> (FREQ_SHIFT - SINC_PHASESHIFT)) * MIXER_SINC_TAPS];
+			const Bits (* window)[2] = &history[historyPos];
+			Bits left = 0, right = 0;
+			for (Bitu k=0;k<MIXER_SINC_TAPS;k++) {
+				left += window[k][0] * coef[k];
+				if (stereo) right += window[k][1] * coef[k];
+			}
+			left >>= SINC_SHIFT;
+			write[0] += left * volmul[0];
+			write[1] += (stereo ? right >> SINC_SHIFT : left) * volmul[1];
+		} else {
 			Bits diff_mul = freq_counter & FREQ_MASK;
 			Bits sample = prevSample[0] + (((nextSample[0] - prevSample[0]) * diff_mul) >> FREQ_SHIFT);
 			write[0] += sample*volmul[0];
@@ -382,14 +580,11 @@ void MixerChannel::AddSamples_s32_nonnative(Bitu len,const Bit32s * data) {
 }
 
 void MixerChannel::FillUp(void) {
-	SDL_LockAudio();
 	if (!enabled || done<mixer.done) {
-		SDL_UnlockAudio();
 		return;
 	}
 	float index=PIC_TickIndex();
 	Mix((Bitu)(index*mixer.needed));
-	SDL_UnlockAudio();
 }
 
 extern bool ticksLocked;
@@ -438,23 +633,32 @@ static void MIXER_MixData(Bitu needed) {
 	mixer.done = needed;
 }
 
-static void MIXER_Mix(void) {
-	SDL_LockAudio();
-	MIXER_MixData(mixer.needed);
-	mixer.tick_counter += mixer.tick_add;
-	mixer.needed+=(mixer.tick_counter >> TICK_SHIFT);
-	mixer.tick_counter &= TICK_MASK;
-	SDL_UnlockAudio();
-}
-
-static void MIXER_Mix_NoSound(void) {
-	MIXER_MixData(mixer.needed);
+/* Move the samples of this tick out of the work buffer and set up the next tick */
+static void MIXER_FinishTick(bool output) {
+	Bitu write = mixer.ring.write;
+	if (output) {
+		Bitu room = MIXER_BUFSIZE - (write - mixer.ring.read);
+		MIXER_BARRIER();
+		if (room < mixer.needed)
+			mixer.stats.overruns++;
+		else room = mixer.needed;
+		for (Bitu i=0;i<room;i++) {
+			Bits sample=mixer.work[(mixer.pos+i)&MIXER_BUFMASK][0]>>MIXER_VOLSHIFT;
+			mixer.ring.data[write & MIXER_BUFMASK][0]=MIXER_CLIP(sample);
+			sample=mixer.work[(mixer.pos+i)&MIXER_BUFMASK][1]>>MIXER_VOLSHIFT;
+			mixer.ring.data[write & MIXER_BUFMASK][1]=MIXER_CLIP(sample);
+			write++;
+		}
+	}
 	/* Clear piece we've just generated */
 	for (Bitu i=0;i<mixer.needed;i++) {
 		mixer.work[mixer.pos][0]=0;
 		mixer.work[mixer.pos][1]=0;
 		mixer.pos=(mixer.pos+1)&MIXER_BUFMASK;
 	}
+	/* Only hand out the samples once they are written */
+	MIXER_BARRIER();
+	mixer.ring.write = write;
 	/* Reduce count in channels */
 	for (MixerChannel * chan=mixer.channels;chan;chan=chan->next) {
 		if (chan->done>mixer.needed) chan->done-=mixer.needed;
@@ -467,6 +671,16 @@ static void MIXER_Mix_NoSound(void) {
 	mixer.done=0;
 }
 
+static void MIXER_Mix(void) {
+	MIXER_MixData(mixer.needed);
+	MIXER_FinishTick(true);
+}
+
+static void MIXER_Mix_NoSound(void) {
+	MIXER_MixData(mixer.needed);
+	MIXER_FinishTick(false);
+}
+
 static void SDLCALL MIXER_CallBack(void * userdata, Uint8 *stream, int len) {
 	Bitu need=(Bitu)len/MIXER_SSIZE;
 	Bit16s * output=(Bit16s *)stream;
@@ -474,20 +688,28 @@ static void SDLCALL MIXER_CallBack(void * userdata, Uint8 *stream, int len) {
 	Bitu pos;
 	//Local resampling counter to manipulate the data when sending it off to the callback
 	Bitu index, index_add;
-	Bits sample;
+	Bitu read = mixer.ring.read;
+	Bitu done = mixer.ring.write - read;
+	MIXER_BARRIER();
+	mixer.stats.latency = done;
+	if (done > mixer.stats.maxLatency) mixer.stats.maxLatency = done;
+	mixer.stats.latencyTotal += done;
+	mixer.stats.callbacks++;
 	/* Enough room in the buffer ? */
-	if (mixer.done < need) {
-//		LOG_MSG("Full underrun need %d, have %d, min %d", need, mixer.done, mixer.min_needed);
-		if((need - mixer.done) > (need >>7) ) //Max 1 procent stretch.
+	if (done < need) {
+//		LOG_MSG("Full underrun need %d, have %d, min %d", need, done, mixer.min_needed);
+		if((need - done) > (need >>7) ) { //Max 1 procent stretch.
+			mixer.stats.underruns++;
 			return;
-		reduce = mixer.done;
+		}
+		reduce = done;
 		index_add = (reduce << TICK_SHIFT) / need;
 		mixer.tick_add = calc_tickadd(mixer.freq+mixer.min_needed);
-	} else if (mixer.done < mixer.max_needed) {
-		Bitu left = mixer.done - need;
+	} else if (done < mixer.max_needed) {
+		Bitu left = done - need;
 		if (left < mixer.min_needed) {
 			if( !Mixer_irq_important() ) {
-				Bitu needed = mixer.needed - need;
+				Bitu needed = left + mixer.needed;
 				Bitu diff = (mixer.min_needed>needed?mixer.min_needed:needed) - left;
 				mixer.tick_add = calc_tickadd(mixer.freq+(diff*3));
 				left = 0; //No stretching as we compensate with the tick_add value
@@ -495,13 +717,13 @@ static void SDLCALL MIXER_CallBack(void * userdata, Uint8 *stream, int len) {
 				left = (mixer.min_needed - left);
 				left = 1 + (2*left) / mixer.min_needed; //left=1,2,3
 			}
-//			LOG_MSG("needed underrun need %d, have %d, min %d, left %d", need, mixer.done, mixer.min_needed, left);
+//			LOG_MSG("needed underrun need %d, have %d, min %d, left %d", need, done, mixer.min_needed, left);
 			reduce = need - left;
 			index_add = (reduce << TICK_SHIFT) / need;
 		} else {
 			reduce = need;
 			index_add = (1 << TICK_SHIFT);
-//			LOG_MSG("regular run need %d, have %d, min %d, left %d", need, mixer.done, mixer.min_needed, left);
+//			LOG_MSG("regular run need %d, have %d, min %d, left %d", need, done, mixer.min_needed, left);
 
 			/* Mixer tick value being updated:
 			 * 3 cases:
@@ -520,58 +742,37 @@ static void SDLCALL MIXER_CallBack(void * userdata, Uint8 *stream, int len) {
 		}
 	} else {
 		/* There is way too much data in the buffer */
-//		LOG_MSG("overflow run need %d, have %d, min %d", need, mixer.done, mixer.min_needed);
-		if (mixer.done > MIXER_BUFSIZE)
-			index_add = MIXER_BUFSIZE - 2*mixer.min_needed;
-		else
-			index_add = mixer.done - 2*mixer.min_needed;
+//		LOG_MSG("overflow run need %d, have %d, min %d", need, done, mixer.min_needed);
+		mixer.stats.overruns++;
+		index_add = done - 2*mixer.min_needed;
 		index_add = (index_add << TICK_SHIFT) / need;
-		reduce = mixer.done - 2* mixer.min_needed;
+		reduce = done - 2* mixer.min_needed;
 		mixer.tick_add = calc_tickadd(mixer.freq-(mixer.min_needed/5));
 	}
-	/* Reduce done count in all channels */
-	for (MixerChannel * chan=mixer.channels;chan;chan=chan->next) {
-		if (chan->done>reduce) chan->done-=reduce;
-		else chan->done=0;
-	}
-
 	// Reset mixer.tick_add when irqs are important
 	if( Mixer_irq_important() )
 		mixer.tick_add = calc_tickadd(mixer.freq);
 
-	mixer.done -= reduce;
-	mixer.needed -= reduce;
-	pos = mixer.pos;
-	mixer.pos = (mixer.pos + reduce) & MIXER_BUFMASK;
+	pos = read;
 	index = 0;
 	if(need != reduce) {
 		while (need--) {
 			Bitu i = (pos + (index >> TICK_SHIFT )) & MIXER_BUFMASK;
 			index += index_add;
-			sample=mixer.work[i][0]>>MIXER_VOLSHIFT;
-			*output++=MIXER_CLIP(sample);
-			sample=mixer.work[i][1]>>MIXER_VOLSHIFT;
-			*output++=MIXER_CLIP(sample);
-		}
-		/* Clean the used buffer */
-		while (reduce--) {
-			pos &= MIXER_BUFMASK;
-			mixer.work[pos][0]=0;
-			mixer.work[pos][1]=0;
-			pos++;
+			*output++=mixer.ring.data[i][0];
+			*output++=mixer.ring.data[i][1];
 		}
 	} else {
 		while (reduce--) {
-			pos &= MIXER_BUFMASK;
-			sample=mixer.work[pos][0]>>MIXER_VOLSHIFT;
-			*output++=MIXER_CLIP(sample);
-			sample=mixer.work[pos][1]>>MIXER_VOLSHIFT;
-			*output++=MIXER_CLIP(sample);
-			mixer.work[pos][0]=0;
-			mixer.work[pos][1]=0;
+			*output++=mixer.ring.data[pos & MIXER_BUFMASK][0];
+			*output++=mixer.ring.data[pos & MIXER_BUFMASK][1];
 			pos++;
 		}
+		reduce = need;
 	}
+	/* Done reading before the emulation may reuse the space */
+	MIXER_BARRIER();
+	mixer.ring.read = read + reduce;
 }
 
 static void MIXER_Stop(Section* sec) {
@@ -626,6 +827,7 @@ public:
 		ShowVolume("MASTER",mixer.mastervol[0],mixer.mastervol[1]);
 		for (chan=mixer.channels;chan;chan=chan->next)
 			ShowVolume(chan->name,chan->volmain[0],chan->volmain[1]);
+		if (cmd->FindExist("/STATS")) ShowStats();
 	}
 private:
 	void ShowVolume(const char * name,float vol0,float vol1) {
@@ -635,6 +837,19 @@ private:
 		);
 	}
 
+	void ShowStats(void) {
+		if (mixer.nosound) {
+			WriteOut("No sound output.\n");
+			return;
+		}
+		Bitu callbacks = mixer.stats.callbacks;
+		Bitu average = callbacks ? mixer.stats.latencyTotal / callbacks : 0;
+		WriteOut("Underruns %d, overruns %d\n",mixer.stats.underruns,mixer.stats.overruns);
+		WriteOut("Buffered %d ms, average %d ms, max %d ms\n",
+			(mixer.stats.latency*1000)/mixer.freq,(average*1000)/mixer.freq,
+			(mixer.stats.maxLatency*1000)/mixer.freq);
+	}
+
 	void ListMidi(){
 		if(midi.handler) midi.handler->ListAll(this);
 	};
@@ -670,6 +885,7 @@ void MIXER_Init(Section* sec) {
 	/* Read out config section */
 	mixer.freq=section->Get_int("rate");
 	mixer.nosound=section->Get_bool("nosound");
+	mixer.sinc=(std::string(section->Get_string("resampler")) == "sinc");
 	mixer.blocksize=section->Get_int("blocksize");
 
 	/* Initialize the internal stuff */
@@ -677,6 +893,8 @@ void MIXER_Init(Section* sec) {
 	mixer.pos=0;
 	mixer.done=0;
 	memset(mixer.work,0,sizeof(mixer.work));
+	mixer.ring.write=0;
+	mixer.ring.read=0;
 	mixer.mastervol[0]=1.0f;
 	mixer.mastervol[1]=1.0f;
 
@@ -168,13 +168,25 @@ struct PICEntry {
 	float index;
 	Bitu value;
 	PIC_EventHandler pic_event;
-	PICEntry * next;
+	Bitu sequence;				//Insertion order, keeps events with equal index in FIFO order
+	Bitu heap_pos;
+	PICEntry * next;			//Free list or chain of pending events with the same handler hash
+	PICEntry * prev;
 };
 
+#define PIC_HANDLERHASH 64
+
+/* The pending events are kept in a binary min-heap ordered on their index,
+ * so adding and dispatching an event is O(log n). Every pending event is also
+ * chained into a small hash table keyed on its handler, so removing the events
+ * of one handler only has to look at those events and not the whole queue. */
 static struct {
 	PICEntry entries[PIC_QUEUESIZE];
+	PICEntry * heap[PIC_QUEUESIZE];
+	Bitu heap_size;
+	PICEntry * handlers[PIC_HANDLERHASH];
 	PICEntry * free_entry;
-	PICEntry * next_entry;
+	Bitu sequence;
 } pic_queue;
 
 static void write_command(Bitu port,Bitu val,Bitu iolen) {
@@ -369,31 +381,73 @@ void PIC_SetIRQMask(Bitu irq, bool masked) {
 	pic->set_imr(newmask);
 }
 
-static void AddEntry(PICEntry * entry) {
-	PICEntry * find_entry=pic_queue.next_entry;
-	if (GCC_UNLIKELY(find_entry ==0)) {
-		entry->next=0;
-		pic_queue.next_entry=entry;
-	} else if (find_entry->index>entry->index) {
-		pic_queue.next_entry=entry;
-		entry->next=find_entry;
-	} else while (find_entry) {
-		if (find_entry->next) {
-			/* See if the next index comes later than this one */
-			if (find_entry->next->index > entry->index) {
-				entry->next=find_entry->next;
-				find_entry->next=entry;
-				break;
-			} else {
-				find_entry=find_entry->next;
-			}
-		} else {
-			entry->next=find_entry->next;
-			find_entry->next=entry;
-			break;
-		}
+static INLINE Bitu HandlerHash(PIC_EventHandler handler) {
+	Bitu val=(Bitu)handler;
+	return ((val>>4)^(val>>10)) & (PIC_HANDLERHASH-1);
+}
+
+static INLINE bool EntryBefore(const PICEntry * a,const PICEntry * b) {
+	if (a->index!=b->index) return a->index<b->index;
+	return (Bits)(a->sequence-b->sequence)<0;
+}
+
+static void HeapSiftUp(Bitu pos) {
+	PICEntry * entry=pic_queue.heap[pos];
+	while (pos>0) {
+		Bitu parent=(pos-1)>>1;
+		if (!EntryBefore(entry,pic_queue.heap[parent])) break;
+		pic_queue.heap[pos]=pic_queue.heap[parent];
+		pic_queue.heap[pos]->heap_pos=pos;
+		pos=parent;
+	}
+	pic_queue.heap[pos]=entry;
+	entry->heap_pos=pos;
+}
+
+static void HeapSiftDown(Bitu pos) {
+	PICEntry * entry=pic_queue.heap[pos];
+	Bitu size=pic_queue.heap_size;
+	for (;;) {
+		Bitu child=pos*2+1;
+		if (child>=size) break;
+		if (child+1<size && EntryBefore(pic_queue.heap[child+1],pic_queue.heap[child])) child++;
+		if (!EntryBefore(pic_queue.heap[child],entry)) break;
+		pic_queue.heap[pos]=pic_queue.heap[child];
+		pic_queue.heap[pos]->heap_pos=pos;
+		pos=child;
 	}
-	Bits cycles=PIC_MakeCycles(pic_queue.next_entry->index-PIC_TickIndex());
+	pic_queue.heap[pos]=entry;
+	entry->heap_pos=pos;
+}
+
+/* Takes an entry out of the heap and the handler chain and puts it in the free list */
+static void RemoveEntry(PICEntry * entry) {
+	Bitu pos=entry->heap_pos;
+	Bitu last=--pic_queue.heap_size;
+	if (pos!=last) {
+		pic_queue.heap[pos]=pic_queue.heap[last];
+		pic_queue.heap[pos]->heap_pos=pos;
+		if (pos>0 && EntryBefore(pic_queue.heap[pos],pic_queue.heap[(pos-1)>>1])) HeapSiftUp(pos);
+		else HeapSiftDown(pos);
+	}
+	if (entry->prev) entry->prev->next=entry->next;
+	else pic_queue.handlers[HandlerHash(entry->pic_event)]=entry->next;
+	if (entry->next) entry->next->prev=entry->prev;
+	entry->next=pic_queue.free_entry;
+	pic_queue.free_entry=entry;
+}
+
+static void AddEntry(PICEntry * entry) {
+	entry->sequence=pic_queue.sequence++;
+	pic_queue.heap[pic_queue.heap_size]=entry;
+	HeapSiftUp(pic_queue.heap_size++);
+	PICEntry * * chain=&pic_queue.handlers[HandlerHash(entry->pic_event)];
+	entry->prev=0;
+	entry->next=*chain;
+	if (entry->next) entry->next->prev=entry;
+	*chain=entry;
+
+	Bits cycles=PIC_MakeCycles(pic_queue.heap[0]->index-PIC_TickIndex());
 	if (cycles<CPU_Cycles) {
 		CPU_CycleLeft+=CPU_Cycles;
 		CPU_Cycles=0;
@@ -418,53 +472,21 @@ void PIC_AddEvent(PIC_EventHandler handler,float delay,Bitu val) {
 }
 
 void PIC_RemoveSpecificEvents(PIC_EventHandler handler, Bitu val) {
-	PICEntry * entry=pic_queue.next_entry;
-	PICEntry * prev_entry;
-	prev_entry = 0;
+	PICEntry * entry=pic_queue.handlers[HandlerHash(handler)];
 	while (entry) {
-		if (GCC_UNLIKELY((entry->pic_event == handler)) && (entry->value == val)) {
-			if (prev_entry) {
-				prev_entry->next=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=prev_entry->next;
-				continue;
-			} else {
-				pic_queue.next_entry=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=pic_queue.next_entry;
-				continue;
-			}
-		}
-		prev_entry=entry;
-		entry=entry->next;
-	}	
+		PICEntry * next_entry=entry->next;
+		if (GCC_UNLIKELY((entry->pic_event == handler)) && (entry->value == val)) RemoveEntry(entry);
+		entry=next_entry;
+	}
 }
 
 void PIC_RemoveEvents(PIC_EventHandler handler) {
-	PICEntry * entry=pic_queue.next_entry;
-	PICEntry * prev_entry;
-	prev_entry=0;
+	PICEntry * entry=pic_queue.handlers[HandlerHash(handler)];
 	while (entry) {
-		if (GCC_UNLIKELY(entry->pic_event==handler)) {
-			if (prev_entry) {
-				prev_entry->next=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=prev_entry->next;
-				continue;
-			} else {
-				pic_queue.next_entry=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=pic_queue.next_entry;
-				continue;
-			}
-		}
-		prev_entry=entry;
-		entry=entry->next;
-	}	
+		PICEntry * next_entry=entry->next;
+		if (GCC_UNLIKELY(entry->pic_event==handler)) RemoveEntry(entry);
+		entry=next_entry;
+	}
 }
 
 
@@ -478,22 +500,20 @@ bool PIC_RunQueue(void) {
 	/* Check the queue for an entry */
 	Bits index_nd=PIC_TickIndexND();
 	InEventService = true;
-	while (pic_queue.next_entry && (pic_queue.next_entry->index*CPU_CycleMax<=index_nd)) {
-		PICEntry * entry=pic_queue.next_entry;
-		pic_queue.next_entry=entry->next;
-
+	while (pic_queue.heap_size && (pic_queue.heap[0]->index*CPU_CycleMax<=index_nd)) {
+		PICEntry * entry=pic_queue.heap[0];
 		srv_lag = entry->index;
-		(entry->pic_event)(entry->value); // call the event handler
-
-		/* Put the entry in the free list */
-		entry->next=pic_queue.free_entry;
-		pic_queue.free_entry=entry;
+		PIC_EventHandler handler=entry->pic_event;
+		Bitu value=entry->value;
+		/* Put the entry in the free list before calling, the handler may add new events */
+		RemoveEntry(entry);
+		handler(value); // call the event handler
 	}
 	InEventService = false;
 
 	/* Check when to set the new cycle end */
-	if (pic_queue.next_entry) {
-		Bits cycles=(Bits)(pic_queue.next_entry->index*CPU_CycleMax-index_nd);
+	if (pic_queue.heap_size) {
+		Bits cycles=(Bits)(pic_queue.heap[0]->index*CPU_CycleMax-index_nd);
 		if (GCC_UNLIKELY(!cycles)) cycles=1;
 		if (cycles<CPU_CycleLeft) {
 			CPU_Cycles=cycles;
@@ -542,10 +562,9 @@ void TIMER_AddTick(void) {
 	CPU_Cycles=0;
 	PIC_Ticks++;
 	/* Go through the list of scheduled events and lower their index with 1000 */
-	PICEntry * entry=pic_queue.next_entry;
-	while (entry) {
-		entry->index -= 1.0;
-		entry=entry->next;
+	/* A uniform shift keeps the heap ordered */
+	for (Bitu i=0;i<pic_queue.heap_size;i++) {
+		pic_queue.heap[i]->index -= 1.0;
 	}
 	/* Call our list of ticker handlers */
 	TickerBlock * ticker=firstticker;
@@ -605,7 +624,9 @@ public:
 		}
 		pic_queue.entries[PIC_QUEUESIZE-1].next=0;
 		pic_queue.free_entry=&pic_queue.entries[0];
-		pic_queue.next_entry=0;
+		pic_queue.heap_size=0;
+		pic_queue.sequence=0;
+		for (i=0;i<PIC_HANDLERHASH;i++) pic_queue.handlers[i]=0;
 	}
 
 	~PIC_8259A(){
@@ -1013,6 +1013,7 @@ void BIOS_ZeroExtendedSize(bool in) {
 
 void BIOS_SetupKeyboard(void);
 void BIOS_SetupDisks(void);
+void BIOS_ShutdownDisks(void);
 
 class BIOS:public Module_base{
 private:
@@ -1299,6 +1300,7 @@ public:
 		BIOS_HostTimeSync();
 	}
 	~BIOS(){
+		BIOS_ShutdownDisks();
 		/* abort DAC playing */
 		if (tandy_sb.port) {
 			IO_Write(tandy_sb.port+0xc,0xd3);
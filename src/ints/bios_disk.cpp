@@ -17,6 +17,8 @@
  */
 
 
+#include <algorithm>
+#include <string>
 #include "dosbox.h"
 #include "callback.h"
 #include "bios.h"
@@ -26,9 +28,26 @@
 #include "dos_inc.h" /* for Drives[] */
 #include "../dos/drives.h"
 #include "mapper.h"
+#include "control.h"
+#include "pic.h"
+#include "timer.h"
+
+#if (C_HAVE_MMAP)
+#include <sys/mman.h>
+#endif
 
 #define MAX_DISK_IMAGES 4
 
+/* Sector cache of the disk images: DISK_CACHE_BLOCKS blocks of
+   DISK_CACHE_SECTORS consecutive sectors each, per image */
+#define DISK_CACHE_SECTORS 16
+#define DISK_CACHE_ALLVALID ((1u<<DISK_CACHE_SECTORS)-1)
+#define DISK_CACHE_BLOCKS 64
+#define DISK_CACHE_READAHEAD 4
+#define DISK_CACHE_MAX_SECTSIZE 4096
+/* milliseconds modified sectors may stay in the cache */
+#define DISK_CACHE_FLUSH_DELAY 1000
+
 diskGeo DiskGeometryList[] = {
 	{ 160,  8, 1, 40, 0},
 	{ 180,  9, 1, 40, 0},
@@ -58,6 +77,8 @@ void CMOS_SetRegister(Bitu regNr, Bit8u val); //For setting equipment word
 /* 2 floppys and 2 harddrives, max */
 imageDisk *imageDiskList[MAX_DISK_IMAGES];
 imageDisk *diskSwap[MAX_SWAPPABLE_DISKS];
+/* all existing images, for the periodic write-back */
+static imageDisk *first_disk = NULL;
 Bit32s swapPosition;
 
 void updateDPT(void) {
@@ -158,19 +179,219 @@ Bit8u imageDisk::Read_Sector(Bit32u head,Bit32u cylinder,Bit32u sector,void * da
 	return Read_AbsoluteSector(sectnum, data);
 }
 
+/* Plain file access, keeps track of the file position to avoid needless seeks */
+void imageDisk::fileRead(Bit32u bytenum,void * data,Bit32u len) {
+	if (layers) {
+		layers->Read(bytenum,(Bit8u *)data,len);
+		return;
+	}
+	if (last_action==WRITE || bytenum!=current_fpos) fseek(diskimg,bytenum,SEEK_SET);
+	size_t ret=fread(data, 1, len, diskimg);
+	/* sectors beyond the end of the image read as zeroes */
+	if (ret<len) memset((Bit8u*)data+ret,0,len-ret);
+	current_fpos=bytenum+ret;
+	last_action=READ;
+}
+
+bool imageDisk::fileWrite(Bit32u bytenum,void * data,Bit32u len) {
+	if (layers) return layers->Write(bytenum,(const Bit8u *)data,len);
+	if (last_action==READ || bytenum!=current_fpos) fseek(diskimg,bytenum,SEEK_SET);
+	size_t ret=fwrite(data, 1, len, diskimg);
+	current_fpos=bytenum+ret;
+	last_action=WRITE;
+	if (current_fpos>image_size) image_size=current_fpos;
+	return (ret==len);
+}
+
+/* The cache is set up on first use, the sector size is only known after Set_Geometry */
+bool imageDisk::cacheReady(void) {
+	if (cache_mode==CACHE_OFF) return false;
+	if (cache_data) {
+		if (cache_sector_size==sector_size) return true;
+		Flush();
+		delete[] cache_data;
+		cache_data=NULL;
+	}
+	if (sector_size==0 || sector_size>DISK_CACHE_MAX_SECTSIZE) return false;
+	/* one additional block used as scratch space when loading partially valid blocks */
+	cache_data=new Bit8u[(DISK_CACHE_BLOCKS+1)*DISK_CACHE_SECTORS*sector_size];
+	cache_sector_size=sector_size;
+	for (Bitu i=0;i<DISK_CACHE_BLOCKS;i++) cache_blocks[i].used=false;
+	cache_last=0;
+	return true;
+}
+
+Bit8u * imageDisk::cacheSector(Bitu index,Bit32u sectnum) {
+	return &cache_data[(index*DISK_CACHE_SECTORS+(sectnum%DISK_CACHE_SECTORS))*cache_sector_size];
+}
+
+/* Returns DISK_CACHE_BLOCKS if the block is not cached */
+Bitu imageDisk::cacheLookup(Bit32u block) {
+	if (cache_blocks[cache_last].used && cache_blocks[cache_last].block==block) return cache_last;
+	for (Bitu i=0;i<DISK_CACHE_BLOCKS;i++) {
+		if (cache_blocks[i].used && cache_blocks[i].block==block) return i;
+	}
+	return DISK_CACHE_BLOCKS;
+}
+
+Bitu imageDisk::cacheAllocate(Bit32u block) {
+	Bitu index=0;
+	for (Bitu i=0;i<DISK_CACHE_BLOCKS;i++) {
+		if (!cache_blocks[i].used) {
+			index=i;
+			break;
+		}
+		if (cache_blocks[i].lru<cache_blocks[index].lru) index=i;
+	}
+	if (cache_blocks[index].used && cache_blocks[index].dirty) cacheWriteBack(index);
+	cache_blocks[index].block=block;
+	cache_blocks[index].lru=++cache_lru;
+	cache_blocks[index].valid=0;
+	cache_blocks[index].dirty=0;
+	cache_blocks[index].used=true;
+	return index;
+}
+
+/* Read count consecutive blocks in one sequential pass over the image file,
+ * returns the index of the first one */
+Bitu imageDisk::cacheLoad(Bit32u block,Bitu count) {
+	Bit32u blocksize=DISK_CACHE_SECTORS*cache_sector_size;
+	Bit8u * scratch=&cache_data[DISK_CACHE_BLOCKS*blocksize];
+	Bitu first=DISK_CACHE_BLOCKS;
+	for (Bitu i=0;i<count;i++,block++) {
+		Bitu index=cacheLookup(block);
+		if (index==DISK_CACHE_BLOCKS) index=cacheAllocate(block);
+		/* blocks loaded earlier in this pass must not be picked for the later ones */
+		else cache_blocks[index].lru=++cache_lru;
+		if (i==0) first=index;
+		cacheBlock & cb=cache_blocks[index];
+		if (cb.valid==DISK_CACHE_ALLVALID) continue;
+		if (cb.valid==0) {
+			fileRead(block*blocksize,cacheSector(index,0),blocksize);
+		} else {
+			/* keep sectors that were written but not read back yet */
+			fileRead(block*blocksize,scratch,blocksize);
+			for (Bitu s=0;s<DISK_CACHE_SECTORS;s++) {
+				if (cb.valid & (1u<<s)) continue;
+				memcpy(cacheSector(index,(Bit32u)s),&scratch[s*cache_sector_size],cache_sector_size);
+			}
+		}
+		cb.valid=DISK_CACHE_ALLVALID;
+	}
+	return first;
+}
+
+/* Write the dirty sectors of a block, consecutive sectors are written together */
+void imageDisk::cacheWriteBack(Bitu index) {
+	cacheBlock & cb=cache_blocks[index];
+	Bitu s=0;
+	while (s<DISK_CACHE_SECTORS) {
+		if (!(cb.dirty & (1u<<s))) {
+			s++;
+			continue;
+		}
+		Bitu first=s;
+		while (s<DISK_CACHE_SECTORS && (cb.dirty & (1u<<s))) s++;
+		Bit32u sectnum=cb.block*DISK_CACHE_SECTORS+(Bit32u)first;
+		if (!fileWrite(sectnum*cache_sector_size,cacheSector(index,sectnum),(Bit32u)(s-first)*cache_sector_size)) {
+			LOG_MSG("Writing to disk image %s failed",diskname);
+		}
+		cache_stats.flushed+=(Bit32u)(s-first);
+	}
+	cb.dirty=0;
+}
+
+struct cacheBlockOrder {
+	const Bit32u * blocks;
+	bool operator()(Bitu a,Bitu b) const { return blocks[a]<blocks[b]; }
+};
+
+/* Write all modified sectors to the image file, in ascending order */
+void imageDisk::Flush(void) {
+#if (C_HAVE_MMAP)
+	if (mapped_image && mapped_dirty) {
+		msync(mapped_image,mapped_size,MS_ASYNC);
+		mapped_dirty=false;
+	}
+#endif
+	if (!cache_dirty) return;
+	cache_dirty=false;
+	Bitu order[DISK_CACHE_BLOCKS];
+	Bit32u blocks[DISK_CACHE_BLOCKS];
+	Bitu count=0;
+	for (Bitu i=0;i<DISK_CACHE_BLOCKS;i++) {
+		blocks[i]=cache_blocks[i].block;
+		if (cache_blocks[i].used && cache_blocks[i].dirty) order[count++]=i;
+	}
+	cacheBlockOrder cmp;
+	cmp.blocks=blocks;
+	std::sort(order,order+count,cmp);
+	for (Bitu i=0;i<count;i++) cacheWriteBack(order[i]);
+	if (layers) layers->Flush();
+	else fflush(diskimg);
+}
+
+/* Called every millisecond, writes back data that has been dirty for a while */
+void imageDisk::Tick(void) {
+	if ((cache_dirty || mapped_dirty) && (PIC_Ticks-dirty_since)>=DISK_CACHE_FLUSH_DELAY) Flush();
+}
+
+void imageDisk::LogStats(void) {
+	Bit32u reads=cache_stats.hits+cache_stats.misses;
+	if (!reads && !cache_stats.writes && !cache_stats.flushed) return;
+#if C_DEBUG
+	LOG(LOG_BIOS,LOG_NORMAL)("Disk %s: %d reads, %d%% cached, %d blocks read ahead, %d writes, %d sectors written back",
+		diskname,reads,reads?(cache_stats.hits*100/reads):0,cache_stats.readahead,cache_stats.writes,cache_stats.flushed);
+#endif
+	memset(&cache_stats,0,sizeof(cache_stats));
+}
+
 Bit8u imageDisk::Read_AbsoluteSector(Bit32u sectnum, void * data) {
 	Bit32u bytenum;
 
 	bytenum = sectnum * sector_size;
 
-	if (last_action==WRITE || bytenum!=current_fpos) fseek(diskimg,bytenum,SEEK_SET);
-	size_t ret=fread(data, 1, sector_size, diskimg);
-	current_fpos=bytenum+ret;
-	last_action=READ;
+	if (mapped_image && bytenum<mapped_size && sector_size<=mapped_size-bytenum) {
+		memcpy(data,&mapped_image[bytenum],sector_size);
+		cache_stats.hits++;
+		return 0x00;
+	}
+
+	if (!cacheReady()) {
+		fileRead(bytenum,data,sector_size);
+		return 0x00;
+	}
+
+	Bit32u block=sectnum/DISK_CACHE_SECTORS;
+	Bit32u mask=1u<<(sectnum%DISK_CACHE_SECTORS);
+	Bitu index=cacheLookup(block);
+	if (index<DISK_CACHE_BLOCKS && (cache_blocks[index].valid & mask)) {
+		cache_stats.hits++;
+	} else {
+		cache_stats.misses++;
+		Bitu count=1;
+		if (sectnum==last_read_sector+1) {
+			/* sequential access, fetch the following blocks as well */
+			Bit32u blocksize=DISK_CACHE_SECTORS*cache_sector_size;
+			while (count<=DISK_CACHE_READAHEAD && (block+count)*blocksize<image_size &&
+				cacheLookup(block+(Bit32u)count)==DISK_CACHE_BLOCKS) count++;
+			cache_stats.readahead+=(Bit32u)(count-1);
+		}
+		index=cacheLoad(block,count);
+	}
+	cache_blocks[index].lru=++cache_lru;
+	cache_last=index;
+	memcpy(data,cacheSector(index,sectnum),sector_size);
+	last_read_sector=sectnum;
 
 	return 0x00;
 }
 
+void imageDisk::Int13Written(Bit32u head,Bit32u cylinder,Bit32u sector) {
+	Bit32u sectnum = ( (cylinder * heads + head) * sectors ) + sector - 1L;
+	if (sectnum>=table_start && sectnum<table_end) table_stale=true;
+}
+
 Bit8u imageDisk::Write_Sector(Bit32u head,Bit32u cylinder,Bit32u sector,void * data) {
 	Bit32u sectnum;
 
@@ -180,6 +401,7 @@ Bit8u imageDisk::Write_Sector(Bit32u head,Bit32u cylinder,Bit32u sector,void * d
 }
 
 
+
 Bit8u imageDisk::Write_AbsoluteSector(Bit32u sectnum, void *data) {
 	Bit32u bytenum;
 
@@ -187,13 +409,55 @@ Bit8u imageDisk::Write_AbsoluteSector(Bit32u sectnum, void *data) {
 
 	//LOG_MSG("Writing sectors to %ld at bytenum %d", sectnum, bytenum);
 
-	if (last_action==READ || bytenum!=current_fpos) fseek(diskimg,bytenum,SEEK_SET);
-	size_t ret=fwrite(data, 1, sector_size, diskimg);
-	current_fpos=bytenum+ret;
-	last_action=WRITE;
+	if (read_only) return 0x05;
+
+	if (mapped_image && bytenum<mapped_size && sector_size<=mapped_size-bytenum) {
+		memcpy(&mapped_image[bytenum],data,sector_size);
+		cache_stats.writes++;
+		if (!mapped_dirty) {
+			mapped_dirty=true;
+			dirty_since=PIC_Ticks;
+		}
+		return 0x00;
+	}
+
+	bool cached=cacheReady();
+	Bit32u block=sectnum/DISK_CACHE_SECTORS;
+	Bit32u mask=1u<<(sectnum%DISK_CACHE_SECTORS);
+
+	/* The first write goes to the file directly, so a read-only image is
+	   reported to the guest instead of failing later during write-back */
+	if (!cached || !write_checked) {
+		if (!fileWrite(bytenum,data,sector_size)) {
+			if (!write_checked) read_only=true;
+			return 0x05;
+		}
+		write_checked=true;
+		if (cached) {
+			Bitu index=cacheLookup(block);
+			if (index<DISK_CACHE_BLOCKS) {
+				memcpy(cacheSector(index,sectnum),data,sector_size);
+				cache_blocks[index].valid|=mask;
+				cache_blocks[index].dirty&=~mask;
+			}
+		}
+		return 0x00;
+	}
 
-	return ((ret>0)?0x00:0x05);
+	Bitu index=cacheLookup(block);
+	if (index==DISK_CACHE_BLOCKS) index=cacheAllocate(block);
+	memcpy(cacheSector(index,sectnum),data,sector_size);
+	cache_blocks[index].valid|=mask;
+	cache_blocks[index].dirty|=mask;
+	cache_blocks[index].lru=++cache_lru;
+	cache_last=index;
+	cache_stats.writes++;
+	if (!cache_dirty) {
+		cache_dirty=true;
+		dirty_since=PIC_Ticks;
+	}
 
+	return 0x00;
 }
 
 imageDisk::imageDisk(FILE *imgFile, Bit8u *imgName, Bit32u imgSizeK, bool isHardDisk) {
@@ -203,7 +467,18 @@ imageDisk::imageDisk(FILE *imgFile, Bit8u *imgName, Bit32u imgSizeK, bool isHard
 	sector_size = 512;
 	current_fpos = 0;
 	last_action = NONE;
+	table_start = table_end = 0;
+	table_stale = false;
 	diskimg = imgFile;
+	/* overlay and compressed images are recognized by their header */
+	layers = imageOverlay::Open(diskimg,(const char *)imgName);
+	if (layers) {
+		image_size = layers->GetSize();
+		imgSizeK = image_size / 1024;
+	} else {
+		fseek(diskimg,0,SEEK_END);
+		image_size = (Bit32u)ftell(diskimg);
+	}
 	fseek(diskimg,0,SEEK_SET);
 	
 	memset(diskname,0,512);
@@ -213,6 +488,41 @@ imageDisk::imageDisk(FILE *imgFile, Bit8u *imgName, Bit32u imgSizeK, bool isHard
 		strcpy((char *)diskname, (const char *)imgName);
 	}
 
+	cache_mode = CACHE_ON;
+	Section_prop * section=static_cast<Section_prop *>(control->GetSection("dos"));
+	if (section) {
+		std::string mode = section->Get_string("imagecache");
+		if (mode == "false") cache_mode = CACHE_OFF;
+		else if (mode == "mmap") cache_mode = CACHE_MMAP;
+	}
+	cache_blocks = (cache_mode == CACHE_OFF) ? NULL : new cacheBlock[DISK_CACHE_BLOCKS];
+	cache_data = NULL;
+	cache_sector_size = 0;
+	cache_lru = 0;
+	cache_last = 0;
+	last_read_sector = 0xffffffff;
+	dirty_since = 0;
+	cache_dirty = false;
+	write_checked = false;
+	read_only = false;
+	memset(&cache_stats,0,sizeof(cache_stats));
+
+	mapped_image = NULL;
+	mapped_size = 0;
+	mapped_dirty = false;
+#if (C_HAVE_MMAP)
+	if (cache_mode == CACHE_MMAP && image_size && !layers) {
+		void * map = mmap(NULL,image_size,PROT_READ|PROT_WRITE,MAP_SHARED,fileno(diskimg),0);
+		if (map != MAP_FAILED) {
+			mapped_image = (Bit8u *)map;
+			mapped_size = image_size;
+		} else LOG_MSG("ImageLoader: mapping %s failed, using the sector cache",diskname);
+	}
+#endif
+
+	next_disk = first_disk;
+	first_disk = this;
+
 	active = false;
 	hardDrive = isHardDisk;
 	if(!isHardDisk) {
@@ -241,6 +551,24 @@ imageDisk::imageDisk(FILE *imgFile, Bit8u *imgName, Bit32u imgSizeK, bool isHard
 	}
 }
 
+imageDisk::~imageDisk() {
+	Flush();
+	LogStats();
+	for (imageDisk ** where=&first_disk;*where;where=&(*where)->next_disk) {
+		if (*where==this) {
+			*where=next_disk;
+			break;
+		}
+	}
+#if (C_HAVE_MMAP)
+	if (mapped_image) munmap(mapped_image,mapped_size);
+#endif
+	delete[] cache_data;
+	delete[] cache_blocks;
+	delete layers;
+	if(diskimg != NULL) { fclose(diskimg); }
+}
+
 void imageDisk::Set_Geometry(Bit32u setHeads, Bit32u setCyl, Bit32u setSect, Bit32u setSectSize) {
 	heads = setHeads;
 	cylinders = setCyl;
@@ -432,6 +760,7 @@ static Bitu INT13_DiskHandler(void) {
             CALLBACK_SCF(true);
 				return CBRET_NONE;
 			}
+			imageDiskList[drivenum]->Int13Written((Bit32u)reg_dh, (Bit32u)(reg_ch | ((reg_cl & 0xc0) << 2)), (Bit32u)((reg_cl & 63) + i));
         }
 		reg_ah = 0x00;
 		CALLBACK_SCF(false);
@@ -570,6 +899,25 @@ static Bitu INT13_DiskHandler(void) {
 }
 
 
+static void BIOS_DiskTick(void) {
+	static Bitu stats_ticks=0;
+	bool log_stats=(++stats_ticks>=1000);
+	if (log_stats) stats_ticks=0;
+	for (imageDisk * disk=first_disk;disk;disk=disk->next_disk) {
+		disk->Tick();
+		if (log_stats) disk->LogStats();
+	}
+}
+
+void BIOS_FlushDisks(void) {
+	for (imageDisk * disk=first_disk;disk;disk=disk->next_disk) disk->Flush();
+}
+
+void BIOS_ShutdownDisks(void) {
+	TIMER_DelTickHandler(&BIOS_DiskTick);
+	BIOS_FlushDisks();
+}
+
 void BIOS_SetupDisks(void) {
 /* TODO Start the time correctly */
 	call_int13=CALLBACK_Allocate();	
@@ -604,6 +952,7 @@ void BIOS_SetupDisks(void) {
 	mem_writeb(BIOS_HARDDISK_COUNT,2);
 
 	MAPPER_AddHandler(swapInNextDisk,MK_f4,MMOD1,"swapimg","Swap Image");
+	TIMER_AddTickHandler(&BIOS_DiskTick);
 	killRead = false;
 	swapping_requested = false;
 }
@@ -0,0 +1,410 @@
+/*
+ *  Copyright (C) 2002-2019  The DOSBox Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+	Layered disk image formats.
+
+	Overlay image: a sparse copy-on-write file on top of a base image that
+	is never written to. The first 512 bytes are the header:
+		0	magic "DBOXOVL\x1a"
+		8	version (1)
+		12	block size in bytes
+		16	size of the image in bytes
+		20	number of blocks
+		24	file offset of the block index
+		28	file offset of the first data block
+		32	name of the base image, zero terminated; written as an
+			absolute path, a relative one is relative to the overlay
+	The index holds a 32 bit entry per block of the image: zero if the
+	block is unmodified, otherwise the position of the block in the overlay
+	file in units of the block size. Modified blocks are appended to the file.
+
+	Compressed image: a read-only image, usable directly or as the base of
+	an overlay. The header is 32 bytes:
+		0	magic "DBOXCMP\x1a"
+		8	version (1)
+		12	block size in bytes
+		16	size of the image in bytes
+		20	number of blocks
+		24	file offset of the block index
+	The index holds blocks+1 file offsets, block i is stored between entry
+	i and i+1. A block is zlib compressed unless it is stored at full size.
+
+	All values are little endian.
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <vector>
+#include "dosbox.h"
+#include "cross.h"
+#include "mem.h"
+#include "bios_disk.h"
+
+#if (C_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+#define OVERLAY_HEADER_SIZE 512
+#define OVERLAY_BLOCK_SIZE 4096
+#define OVERLAY_NAME_OFFSET 32
+#define COMPRESSED_HEADER_SIZE 32
+#define COMPRESSED_BLOCK_SIZE 65536
+
+static const char overlay_magic[8]={'D','B','O','X','O','V','L',0x1a};
+static const char compressed_magic[8]={'D','B','O','X','C','M','P',0x1a};
+
+static bool readHeader(FILE * file,Bit8u * header,Bitu len) {
+	fseek(file,0,SEEK_SET);
+	return (fread(header,1,len,file)==len);
+}
+
+static Bit32u fileSize(FILE * file) {
+	fseek(file,0,SEEK_END);
+	return (Bit32u)ftell(file);
+}
+
+imageOverlay::imageOverlay() {
+	overlay=NULL;
+	base=NULL;
+	own_base=false;
+	compressed=false;
+	image_size=0;
+	cimage_size=0;
+	block_size=OVERLAY_BLOCK_SIZE;
+	index_offset=0;
+	next_block=0;
+	cblock_size=0;
+	cached_block=0xffffffff;
+}
+
+imageOverlay::~imageOverlay() {
+	if (own_base && base) fclose(base);
+}
+
+/* Prepare reading from a compressed image */
+bool imageOverlay::OpenCompressed(FILE * file,const Bit8u * header) {
+	if (host_readd((HostPt)&header[8])!=1) return false;
+	Bit32u size=host_readd((HostPt)&header[16]);
+	Bit32u count=host_readd((HostPt)&header[20]);
+	Bit32u offset=host_readd((HostPt)&header[24]);
+	cblock_size=host_readd((HostPt)&header[12]);
+	if (cblock_size==0 || cblock_size>16*1024*1024) return false;
+	if (count!=(Bit32u)(((Bit64u)size+cblock_size-1)/cblock_size)) return false;
+	std::vector<Bit8u> raw((count+1)*4);
+	fseek(file,offset,SEEK_SET);
+	if (fread(&raw[0],1,raw.size(),file)!=raw.size()) return false;
+	cindex.resize(count+1);
+	for (Bit32u i=0;i<=count;i++) cindex[i]=host_readd((HostPt)&raw[i*4]);
+	cdata.resize(cblock_size);
+	cimage_size=size;
+	compressed=true;
+	return true;
+}
+
+imageOverlay * imageOverlay::Open(FILE * imgFile,const char * imgName) {
+	Bit8u header[OVERLAY_HEADER_SIZE];
+	if (!readHeader(imgFile,header,COMPRESSED_HEADER_SIZE)) return NULL;
+	if (!memcmp(header,compressed_magic,8)) {
+		imageOverlay * layers=new imageOverlay();
+		layers->base=imgFile;
+		if (layers->OpenCompressed(imgFile,header)) layers->image_size=layers->cimage_size;
+		else LOG_MSG("ImageLoader: %s is not a valid compressed image",imgName);
+		return layers;
+	}
+	if (memcmp(header,overlay_magic,8)) return NULL;
+
+	imageOverlay * layers=new imageOverlay();
+	layers->overlay=imgFile;
+	if (!readHeader(imgFile,header,OVERLAY_HEADER_SIZE) || host_readd((HostPt)&header[8])!=1) {
+		LOG_MSG("ImageLoader: %s is not a valid overlay image",imgName);
+		return layers;
+	}
+	header[OVERLAY_HEADER_SIZE-1]=0;
+	const char * basename=(const char *)&header[OVERLAY_NAME_OFFSET];
+	/* a relative name is taken relative to the directory of the overlay */
+	std::string overlayname(imgName);
+	std::string::size_type split=overlayname.rfind(CROSS_FILESPLIT);
+	if (!Cross::IsPathAbsolute(basename) && split!=std::string::npos) {
+		layers->base=fopen((overlayname.substr(0,split+1)+basename).c_str(),"rb");
+	}
+	if (!layers->base) layers->base=fopen(basename,"rb");
+	if (!layers->base) {
+		LOG_MSG("ImageLoader: base image %s of overlay %s not found",basename,imgName);
+		return layers;
+	}
+	layers->own_base=true;
+	Bit8u base_header[COMPRESSED_HEADER_SIZE];
+	if (readHeader(layers->base,base_header,COMPRESSED_HEADER_SIZE) && !memcmp(base_header,compressed_magic,8)) {
+		if (!layers->OpenCompressed(layers->base,base_header)) {
+			LOG_MSG("ImageLoader: %s is not a valid compressed image",basename);
+			return layers;
+		}
+	}
+
+	layers->block_size=host_readd((HostPt)&header[12]);
+	Bit32u size=host_readd((HostPt)&header[16]);
+	Bit32u count=host_readd((HostPt)&header[20]);
+	layers->index_offset=host_readd((HostPt)&header[24]);
+	Bit32u data_offset=host_readd((HostPt)&header[28]);
+	if (layers->block_size==0 || count!=(Bit32u)(((Bit64u)size+layers->block_size-1)/layers->block_size) ||
+		(layers->compressed && layers->cimage_size!=size)) {
+		LOG_MSG("ImageLoader: %s is not a valid overlay image",imgName);
+		layers->image_size=0;
+		return layers;
+	}
+	std::vector<Bit8u> raw(count*4+1);
+	fseek(imgFile,layers->index_offset,SEEK_SET);
+	if (fread(&raw[0],1,count*4,imgFile)!=count*4) {
+		LOG_MSG("ImageLoader: %s is not a valid overlay image",imgName);
+		layers->image_size=0;
+		return layers;
+	}
+	layers->blocks.resize(count);
+	for (Bit32u i=0;i<count;i++) layers->blocks[i]=host_readd((HostPt)&raw[i*4]);
+	/* new blocks go behind everything present, a partially written block included */
+	Bit32u end=fileSize(imgFile);
+	if (end<data_offset) end=data_offset;
+	layers->next_block=(end+layers->block_size-1)/layers->block_size;
+	layers->image_size=size;
+	return layers;
+}
+
+/* Size of the image as seen by the guest, zero for a damaged layered image */
+Bit32u imageOverlay::GetImageSize(FILE * imgFile) {
+	Bit8u header[COMPRESSED_HEADER_SIZE];
+	if (readHeader(imgFile,header,COMPRESSED_HEADER_SIZE) &&
+		(!memcmp(header,overlay_magic,8) || !memcmp(header,compressed_magic,8))) {
+		imageOverlay * layers=Open(imgFile,"");
+		Bit32u size=layers->image_size;
+		delete layers;
+		return size;
+	}
+	return fileSize(imgFile);
+}
+
+bool imageOverlay::LoadCompressed(Bit32u block) {
+	if (block==cached_block) return true;
+	cached_block=0xffffffff;
+	if (block+1>=cindex.size() || cindex[block+1]<cindex[block]) return false;
+	Bit32u stored=cindex[block+1]-cindex[block];
+	Bit32u size=cimage_size-block*cblock_size;
+	if (size>cblock_size) size=cblock_size;
+	if (stored>cblock_size*2) return false;
+	cbuffer.resize(stored+1);
+	fseek(base,cindex[block],SEEK_SET);
+	if (fread(&cbuffer[0],1,stored,base)!=stored) return false;
+	if (stored==size) {
+		memcpy(&cdata[0],&cbuffer[0],size);
+	} else {
+#if (C_HAVE_ZLIB)
+		uLongf len=cblock_size;
+		if (uncompress(&cdata[0],&len,&cbuffer[0],stored)!=Z_OK || len!=size) return false;
+#else
+		return false;
+#endif
+	}
+	cached_block=block;
+	return true;
+}
+
+/* Read from the base image, the caller keeps within the image size */
+void imageOverlay::ReadBase(Bit32u bytenum,Bit8u * data,Bit32u len) {
+	if (!base) {
+		memset(data,0,len);
+		return;
+	}
+	if (!compressed) {
+		fseek(base,bytenum,SEEK_SET);
+		size_t ret=fread(data,1,len,base);
+		if (ret<len) memset(data+ret,0,len-ret);
+		return;
+	}
+	while (len) {
+		Bit32u block=bytenum/cblock_size;
+		Bit32u offset=bytenum%cblock_size;
+		Bit32u piece=cblock_size-offset;
+		if (piece>len) piece=len;
+		if (LoadCompressed(block)) memcpy(data,&cdata[offset],piece);
+		else {
+			LOG_MSG("ImageLoader: block %d of the compressed image is damaged",block);
+			memset(data,0,piece);
+		}
+		bytenum+=piece;data+=piece;len-=piece;
+	}
+}
+
+void imageOverlay::Read(Bit32u bytenum,Bit8u * data,Bit32u len) {
+	/* reads beyond the end of the image return zeroes */
+	if (bytenum>=image_size) {
+		memset(data,0,len);
+		return;
+	}
+	if (len>image_size-bytenum) {
+		memset(data+(image_size-bytenum),0,len-(image_size-bytenum));
+		len=image_size-bytenum;
+	}
+	if (!overlay) {
+		ReadBase(bytenum,data,len);
+		return;
+	}
+	while (len) {
+		Bit32u block=bytenum/block_size;
+		Bit32u offset=bytenum%block_size;
+		Bit32u piece=block_size-offset;
+		if (piece>len) piece=len;
+		if (block>=blocks.size()) {
+			memset(data,0,len);
+			return;
+		}
+		if (blocks[block]) {
+			fseek(overlay,blocks[block]*block_size+offset,SEEK_SET);
+			size_t ret=fread(data,1,piece,overlay);
+			if (ret<piece) memset(data+ret,0,piece-ret);
+		} else ReadBase(bytenum,data,piece);
+		bytenum+=piece;data+=piece;len-=piece;
+	}
+}
+
+bool imageOverlay::Write(Bit32u bytenum,const Bit8u * data,Bit32u len) {
+	if (!overlay || !base) return false;
+	if (bytenum>=image_size || len>image_size-bytenum) return false;
+	while (len) {
+		Bit32u block=bytenum/block_size;
+		Bit32u offset=bytenum%block_size;
+		Bit32u piece=block_size-offset;
+		if (piece>len) piece=len;
+		if (block>=blocks.size()) return false;
+		if (!blocks[block]) {
+			/* copy the block from the base image, then the index entry refers to it */
+			std::vector<Bit8u> copy(block_size);
+			Bit32u start=block*block_size;
+			Bit32u size=image_size-start;
+			if (size>block_size) size=block_size;
+			ReadBase(start,&copy[0],size);
+			memcpy(&copy[offset],data,piece);
+			fseek(overlay,next_block*block_size,SEEK_SET);
+			if (fwrite(&copy[0],1,block_size,overlay)!=block_size) return false;
+			Bit8u entry[4];
+			host_writed((HostPt)entry,next_block);
+			fseek(overlay,index_offset+block*4,SEEK_SET);
+			if (fwrite(entry,1,4,overlay)!=4) return false;
+			blocks[block]=next_block++;
+		} else {
+			fseek(overlay,blocks[block]*block_size+offset,SEEK_SET);
+			if (fwrite(data,1,piece,overlay)!=piece) return false;
+		}
+		bytenum+=piece;data+=piece;len-=piece;
+	}
+	return true;
+}
+
+void imageOverlay::Flush(void) {
+	if (overlay) fflush(overlay);
+}
+
+bool imageOverlay::Create(const char * overlayName,const char * baseName) {
+	/* the overlay must find its base from any working directory */
+	std::string fullname(baseName);
+	if (!Cross::IsPathAbsolute(fullname)) {
+		char cwd[CROSS_LEN];
+		if (getcwd(cwd,CROSS_LEN) == NULL) return false;
+		fullname = std::string(cwd) + CROSS_FILESPLIT + fullname;
+	}
+	if (fullname.size()>=OVERLAY_HEADER_SIZE-OVERLAY_NAME_OFFSET) return false;
+	FILE * basefile=fopen(fullname.c_str(),"rb");
+	if (!basefile) return false;
+	Bit32u size=GetImageSize(basefile);
+	fclose(basefile);
+	if (!size) return false;
+
+	Bit32u count=(Bit32u)(((Bit64u)size+OVERLAY_BLOCK_SIZE-1)/OVERLAY_BLOCK_SIZE);
+	Bit32u data_offset=(OVERLAY_HEADER_SIZE+count*4+OVERLAY_BLOCK_SIZE-1) & ~(OVERLAY_BLOCK_SIZE-1);
+	std::vector<Bit8u> start(data_offset,0);
+	memcpy(&start[0],overlay_magic,8);
+	host_writed((HostPt)&start[8],1);
+	host_writed((HostPt)&start[12],OVERLAY_BLOCK_SIZE);
+	host_writed((HostPt)&start[16],size);
+	host_writed((HostPt)&start[20],count);
+	host_writed((HostPt)&start[24],OVERLAY_HEADER_SIZE);
+	host_writed((HostPt)&start[28],data_offset);
+	strcpy((char *)&start[OVERLAY_NAME_OFFSET],fullname.c_str());
+
+	FILE * file=fopen(overlayName,"wb");
+	if (!file) return false;
+	bool ok=(fwrite(&start[0],1,data_offset,file)==data_offset);
+	if (fclose(file)) ok=false;
+	return ok;
+}
+
+bool imageOverlay::Compress(const char * imgName,const char * compressedName) {
+#if (C_HAVE_ZLIB)
+	FILE * src=fopen(imgName,"rb");
+	if (!src) return false;
+	Bit32u size=fileSize(src);
+	fseek(src,0,SEEK_SET);
+	FILE * dst=fopen(compressedName,"wb");
+	if (!dst) {
+		fclose(src);
+		return false;
+	}
+	Bit32u count=(Bit32u)(((Bit64u)size+COMPRESSED_BLOCK_SIZE-1)/COMPRESSED_BLOCK_SIZE);
+	std::vector<Bit8u> header(COMPRESSED_HEADER_SIZE,0);
+	memcpy(&header[0],compressed_magic,8);
+	host_writed((HostPt)&header[8],1);
+	host_writed((HostPt)&header[12],COMPRESSED_BLOCK_SIZE);
+	host_writed((HostPt)&header[16],size);
+	host_writed((HostPt)&header[20],count);
+	host_writed((HostPt)&header[24],COMPRESSED_HEADER_SIZE);
+	/* the index is written once all block offsets are known */
+	std::vector<Bit8u> index((count+1)*4,0);
+	bool ok=(fwrite(&header[0],1,header.size(),dst)==header.size()) &&
+		(fwrite(&index[0],1,index.size(),dst)==index.size());
+
+	std::vector<Bit8u> raw(COMPRESSED_BLOCK_SIZE);
+	std::vector<Bit8u> packed(compressBound(COMPRESSED_BLOCK_SIZE));
+	Bit32u offset=COMPRESSED_HEADER_SIZE+(count+1)*4;
+	for (Bit32u i=0;ok && i<count;i++) {
+		Bit32u len=size-i*COMPRESSED_BLOCK_SIZE;
+		if (len>COMPRESSED_BLOCK_SIZE) len=COMPRESSED_BLOCK_SIZE;
+		if (fread(&raw[0],1,len,src)!=len) {
+			ok=false;
+			break;
+		}
+		host_writed((HostPt)&index[i*4],offset);
+		uLongf packed_len=(uLongf)packed.size();
+		if (compress2(&packed[0],&packed_len,&raw[0],len,Z_BEST_COMPRESSION)==Z_OK && packed_len<len) {
+			ok=(fwrite(&packed[0],1,packed_len,dst)==packed_len);
+			offset+=(Bit32u)packed_len;
+		} else {
+			ok=(fwrite(&raw[0],1,len,dst)==len);
+			offset+=len;
+		}
+	}
+	host_writed((HostPt)&index[count*4],offset);
+	if (ok) {
+		fseek(dst,COMPRESSED_HEADER_SIZE,SEEK_SET);
+		ok=(fwrite(&index[0],1,index.size(),dst)==index.size());
+	}
+	fclose(src);
+	if (fclose(dst)) ok=false;
+	return ok;
+#else
+	return false;
+#endif
+}
@@ -24,6 +24,11 @@
 
 #include "zmbv.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ZMBV_SSE2 1
+#include <emmintrin.h>
+#endif
+
 #define DBZV_VERSION_HIGH 0
 #define DBZV_VERSION_LOW 1
 
@@ -146,6 +151,80 @@ void VideoCodec::CreateVectorTable(void) {
 	}
 }
 
+/* Count the pixels in a row that differ in their lower 24 bits */
+template<class P>
+static INLINE int ChangedPixels(const P * pold,const P * pnew,int count) {
+	int ret=0;
+	for (int x=0;x<count;x++) {
+		int test=0-((pold[x]-pnew[x])&0x00ffffff);
+		ret-=(test>>31);
+	}
+	return ret;
+}
+
+/* Xor a row into the work buffer, the same for every pixel size */
+static INLINE void XorRow(unsigned char * dest,const unsigned char * pold,const unsigned char * pnew,int size) {
+	int x=0;
+#if ZMBV_SSE2
+	for (;x+16<=size;x+=16) {
+		__m128i a=_mm_loadu_si128((const __m128i *)(pold+x));
+		__m128i b=_mm_loadu_si128((const __m128i *)(pnew+x));
+		_mm_storeu_si128((__m128i *)(dest+x),_mm_xor_si128(a,b));
+	}
+#endif
+	for (;x<size;x++)
+		dest[x]=pnew[x]^pold[x];
+}
+
+#if ZMBV_SSE2
+static INLINE int BitCount(unsigned int v) {
+	v=v-((v>>1)&0x55555555);
+	v=(v&0x33333333)+((v>>2)&0x33333333);
+	return (((v+(v>>4))&0x0f0f0f0f)*0x01010101)>>24;
+}
+
+template<>
+INLINE int ChangedPixels<char>(const char * pold,const char * pnew,int count) {
+	int ret=0,x=0;
+	for (;x+16<=count;x+=16) {
+		__m128i a=_mm_loadu_si128((const __m128i *)(pold+x));
+		__m128i b=_mm_loadu_si128((const __m128i *)(pnew+x));
+		ret+=16-BitCount(_mm_movemask_epi8(_mm_cmpeq_epi8(a,b)));
+	}
+	for (;x<count;x++)
+		ret+=(pold[x]!=pnew[x]);
+	return ret;
+}
+
+template<>
+INLINE int ChangedPixels<short>(const short * pold,const short * pnew,int count) {
+	int ret=0,x=0;
+	for (;x+8<=count;x+=8) {
+		__m128i a=_mm_loadu_si128((const __m128i *)(pold+x));
+		__m128i b=_mm_loadu_si128((const __m128i *)(pnew+x));
+		ret+=8-BitCount(_mm_movemask_epi8(_mm_cmpeq_epi16(a,b)))/2;
+	}
+	for (;x<count;x++)
+		ret+=(pold[x]!=pnew[x]);
+	return ret;
+}
+
+template<>
+INLINE int ChangedPixels<int>(const int * pold,const int * pnew,int count) {
+	int ret=0,x=0;
+	const __m128i mask=_mm_set1_epi32(0x00ffffff);
+	for (;x+4<=count;x+=4) {
+		__m128i a=_mm_loadu_si128((const __m128i *)(pold+x));
+		__m128i b=_mm_loadu_si128((const __m128i *)(pnew+x));
+		__m128i diff=_mm_and_si128(_mm_xor_si128(a,b),mask);
+		ret+=4-BitCount(_mm_movemask_epi8(_mm_cmpeq_epi32(diff,_mm_setzero_si128())))/4;
+	}
+	for (;x<count;x++)
+		ret+=((pold[x]^pnew[x])&0x00ffffff)!=0;
+	return ret;
+}
+#endif
+
 template<class P>
 INLINE int VideoCodec::PossibleBlock(int vx,int vy,FrameBlock * block) {
 	int ret=0;
@@ -168,10 +247,7 @@ INLINE int VideoCodec::CompareBlock(int vx,int vy,FrameBlock * block) {
 	P * pold=((P*)oldframe)+block->start+(vy*pitch)+vx;
 	P * pnew=((P*)newframe)+block->start;;	
 	for (int y=0;y<block->dy;y++) {
-		for (int x=0;x<block->dx;x++) {
-			int test=0-((pold[x]-pnew[x])&0x00ffffff);
-			ret-=(test>>31);
-		}
+		ret+=ChangedPixels<P>(pold,pnew,block->dx);
 		pold+=pitch;
 		pnew+=pitch;
 	}
@@ -182,26 +258,19 @@ template<class P>
 INLINE void VideoCodec::AddXorBlock(int vx,int vy,FrameBlock * block) {
 	P * pold=((P*)oldframe)+block->start+(vy*pitch)+vx;
 	P * pnew=((P*)newframe)+block->start;
+	int rowSize=block->dx*sizeof(P);
 	for (int y=0;y<block->dy;y++) {
-		for (int x=0;x<block->dx;x++) {
-			*((P*)&work[workUsed])=pnew[x] ^ pold[x];
-			workUsed+=sizeof(P);
-		}
+		XorRow(&work[workUsed],(unsigned char *)pold,(unsigned char *)pnew,rowSize);
+		workUsed+=rowSize;
 		pold+=pitch;
 		pnew+=pitch;
 	}
 }
 
+/* Find the best vector for every step'th block, the blocks don't depend on each other */
 template<class P>
-void VideoCodec::AddXorFrame(void) {
-	int written=0;
-	int lastvector=0;
-	signed char * vectors=(signed char*)&work[workUsed];
-	/* Align the following xor data on 4 byte boundary*/
-	workUsed=(workUsed + blockcount*2 +3) & ~3;
-	int totalx=0;
-	int totaly=0;
-	for (int b=0;b<blockcount;b++) {
+void VideoCodec::SearchBlocks(int first, int step) {
+	for (int b=first;b<blockcount;b+=step) {
 		FrameBlock * block=&blocks[b];
 		int bestvx = 0;
 		int bestvy = 0;
@@ -222,11 +291,95 @@ void VideoCodec::AddXorFrame(void) {
 				}
 			}
 		}
-		vectors[b*2+0]=(bestvx << 1);
-		vectors[b*2+1]=(bestvy << 1);
-		if (bestchange) {
+		block->bestvx=bestvx;
+		block->bestvy=bestvy;
+		block->bestchange=bestchange;
+	}
+}
+
+void VideoCodec::SearchBlocks(int first, int step) {
+	switch (format) {
+	case ZMBV_FORMAT_8BPP:
+		SearchBlocks<char>(first,step);
+		break;
+	case ZMBV_FORMAT_15BPP:
+	case ZMBV_FORMAT_16BPP:
+		SearchBlocks<short>(first,step);
+		break;
+	case ZMBV_FORMAT_32BPP:
+		SearchBlocks<int>(first,step);
+		break;
+	default:
+		break;
+	}
+}
+
+#ifdef ZMBV_SEARCH_THREADS
+int VideoCodec::SearchThreadProc(void * data) {
+	SearchThread * search=(SearchThread *)data;
+	VideoCodec * codec=search->codec;
+	for (;;) {
+		SDL_SemWait(search->start);
+		if (codec->searchQuit) break;
+		codec->SearchBlocks(search->first,codec->searchThreadCount+1);
+		SDL_SemPost(search->done);
+	}
+	return 0;
+}
+
+void VideoCodec::StartSearchThreads(void) {
+	searchQuit=false;
+	for (searchThreadCount=0;searchThreadCount<ZMBV_SEARCH_THREADS-1;searchThreadCount++) {
+		SearchThread * search=&searchThreads[searchThreadCount];
+		search->codec=this;
+		search->first=searchThreadCount+1;
+		search->start=SDL_CreateSemaphore(0);
+		search->done=SDL_CreateSemaphore(0);
+		search->thread=SDL_CreateThread(&SearchThreadProc,search);
+		if (!search->thread) {
+			SDL_DestroySemaphore(search->start);
+			SDL_DestroySemaphore(search->done);
+			break;
+		}
+	}
+}
+
+void VideoCodec::StopSearchThreads(void) {
+	searchQuit=true;
+	for (int i=0;i<searchThreadCount;i++) {
+		SearchThread * search=&searchThreads[i];
+		SDL_SemPost(search->start);
+		SDL_WaitThread(search->thread,0);
+		SDL_DestroySemaphore(search->start);
+		SDL_DestroySemaphore(search->done);
+	}
+	searchThreadCount=0;
+}
+#endif
+
+template<class P>
+void VideoCodec::AddXorFrame(void) {
+	signed char * vectors=(signed char*)&work[workUsed];
+	/* Align the following xor data on 4 byte boundary*/
+	workUsed=(workUsed + blockcount*2 +3) & ~3;
+#ifdef ZMBV_SEARCH_THREADS
+	int i;
+	for (i=0;i<searchThreadCount;i++)
+		SDL_SemPost(searchThreads[i].start);
+	SearchBlocks<P>(0,searchThreadCount+1);
+	for (i=0;i<searchThreadCount;i++)
+		SDL_SemWait(searchThreads[i].done);
+#else
+	SearchBlocks<P>(0,1);
+#endif
+	/* Output in block order, so the result doesn't depend on the threads */
+	for (int b=0;b<blockcount;b++) {
+		FrameBlock * block=&blocks[b];
+		vectors[b*2+0]=(block->bestvx << 1);
+		vectors[b*2+1]=(block->bestvy << 1);
+		if (block->bestchange) {
 			vectors[b*2+0]|=1;
-			AddXorBlock<P>(bestvx, bestvy, block);
+			AddXorBlock<P>(block->bestvx, block->bestvy, block);
 		}
 	}
 }
@@ -238,6 +391,10 @@ bool VideoCodec::SetupCompress( int _width, int _height ) {
 	format = ZMBV_FORMAT_NONE;
 	if (deflateInit (&zstream, 4) != Z_OK)
 		return false;
+#ifdef ZMBV_SEARCH_THREADS
+	if (!searchThreadCount)
+		StartSearchThreads();
+#endif
 	return true;
 }
 
@@ -348,7 +505,7 @@ int VideoCodec::FinishCompressFrame( void ) {
 			AddXorFrame<short>();
 			break;
 		case ZMBV_FORMAT_32BPP:
-			AddXorFrame<long>();
+			AddXorFrame<int>();
 			break;
 		}
 	}
@@ -469,7 +626,7 @@ bool VideoCodec::DecompressFrame(void * framedata, int size) {
 			UnXorFrame<short>();
 			break;
 		case ZMBV_FORMAT_32BPP:
-			UnXorFrame<long>();
+			UnXorFrame<int>();
 			break;
 		}
 	}
@@ -546,4 +703,13 @@ VideoCodec::VideoCodec() {
 	buf2 = 0;
 	work = 0;
 	memset( &zstream, 0, sizeof(zstream));
+#ifdef ZMBV_SEARCH_THREADS
+	searchThreadCount = 0;
+#endif
+}
+
+VideoCodec::~VideoCodec() {
+#ifdef ZMBV_SEARCH_THREADS
+	StopSearchThreads();
+#endif
 }
@@ -26,6 +26,11 @@
 
 #define CODEC_4CC "ZMBV"
 
+/* Define ZMBV_SEARCH_THREADS to the number of threads used for the motion search, needs SDL */
+#ifdef ZMBV_SEARCH_THREADS
+#include "SDL_thread.h"
+#endif
+
 typedef enum {
 	ZMBV_FORMAT_NONE		= 0x00,
 	ZMBV_FORMAT_1BPP		= 0x01,
@@ -44,6 +49,7 @@ private:
 	struct FrameBlock {
 		int start;
 		int dx,dy;
+		int bestvx,bestvy,bestchange;	//Result of the motion search
 	};
 	struct CodecVector {
 		int x,y;
@@ -84,11 +90,28 @@ private:
 
 	z_stream zstream;
 
+#ifdef ZMBV_SEARCH_THREADS
+	struct SearchThread {
+		VideoCodec *codec;
+		int first;
+		SDL_Thread *thread;
+		SDL_sem *start, *done;
+	} searchThreads[ZMBV_SEARCH_THREADS-1];
+	int searchThreadCount;
+	volatile bool searchQuit;
+	static int SearchThreadProc(void * data);
+	void StartSearchThreads(void);
+	void StopSearchThreads(void);
+#endif
+
 	// methods
 	void FreeBuffers(void);
 	void CreateVectorTable(void);
 	bool SetupBuffers(zmbv_format_t format, int blockwidth, int blockheight);
 
+	void SearchBlocks(int first, int step);
+	template<class P>
+		void SearchBlocks(int first, int step);
 	template<class P>
 		void AddXorFrame(void);
 	template<class P>
@@ -105,6 +128,7 @@ private:
 		INLINE void CopyBlock(int vx, int vy,FrameBlock * block);
 public:
 	VideoCodec();
+	~VideoCodec();
 	bool SetupCompress( int _width, int _height);
 	bool SetupDecompress( int _width, int _height);
 	zmbv_format_t BPPFormat( int bpp );
@@ -34,6 +34,9 @@
 /* Enable memory function inlining in */
 #define C_CORE_INLINE 0
 
+/* Threaded opcode dispatch in the normal core, needs the gcc labels as values extension */
+#define C_CORE_THREADED 0
+
 /* Enable the FPU module, still only for beta testing */
 #define C_FPU 1
 